@@ -18,6 +18,7 @@
 
 #include <type_traits>
 #include <cstdarg>
+#include <stdio.h>
 
 namespace beautifulcode
 {
@@ -25,6 +26,42 @@ namespace beautifulcode
 	enum Alloc_T { Alloc };
 	enum Concat_T { Concat };
 	enum Sprintf_T { Sprintf };
+	enum Format_T { Format };
+
+	// SharedArray's of T count references atomically, so they may be shared between threads. Defining
+	// SLICE_ATOMIC_REFCOUNT makes this the default for every type, otherwise it may be specialised for particular
+	// element types. Their allocations carry a separate counter, which is also made by Array<T>, ready to be shared
+	template <typename T>
+	struct AtomicRefCount
+	{
+#if defined(SLICE_ATOMIC_REFCOUNT)
+		enum { value = true };
+#else
+		enum { value = false };
+#endif
+	};
+
+	// SharedArray's of T count references with biased counting, which is thread safe like AtomicRefCount, but the
+	// thread which allocates an array counts its own references without atomics. Defining SLICE_BIASED_REFCOUNT makes
+	// this the default for every type, otherwise it may be specialised for particular element types
+	template <typename T>
+	struct BiasedRefCount
+	{
+#if defined(SLICE_BIASED_REFCOUNT)
+		enum { value = true };
+#else
+		enum { value = false };
+#endif
+	};
+
+	// T may be moved to another address by copying its bytes, and not destroying the original. Array<T> grows arrays
+	// of these in place with SLICE_REALLOC, and relocates them with memcpy. It may be specialised for types which hold
+	// no pointers into themselves, but aren't trivially copyable
+	template <typename T>
+	struct TriviallyRelocatable
+	{
+		enum { value = std::is_trivially_copyable<T>::value };
+	};
 
 	template <typename T, size_t Count = 0, bool IsString = detail::IsSomeChar<T>::value>
 	struct Array : public Slice<T>
@@ -144,6 +181,7 @@ namespace beautifulcode
 		Array(Reserve_T, size_t count) noexcept;
 		template <typename... Items> Array(Concat_T, const Items&... items) noexcept;
 		template <typename U> Array(Sprintf_T, const U *format, ...) noexcept;
+		template <typename F, typename... Args> Array(Format_T, const F &format, const Args&... args) noexcept;
 
 		Array<C, Count, true>& operator=(const Array<C, Count, true> &str) noexcept;
 		template <typename U, size_t N, bool S> Array<C, Count, true>& operator=(Array<U, N, S> &&rval) noexcept;
@@ -157,6 +195,12 @@ namespace beautifulcode
 		template <typename U> Array<C, Count, true>& sprintf(const U *format, ...) noexcept;
 		// should there be an appending sprintf?
 
+		// format strings substitute "{}" with the next argument, or "{n}" with argument n; "{{" and "}}" are escapes for
+		// braces. arguments may be any item accepted by Concat. the format may be a string, or SLICE_FORMAT("...") which
+		// is parsed and checked against the arguments at compile time
+		template <typename F, typename... Args> Array<C, Count, true>& format(const F &format, const Args&... args) noexcept;
+		template <typename F, typename... Args> Array<C, Count, true>& append_format(const F &format, const Args&... args) noexcept;
+
 		Array<C, Count, true>& to_upper_in_place() noexcept;
 		Array<C, Count, true>& to_lower_in_place() noexcept;
 
@@ -169,6 +213,31 @@ namespace beautifulcode
 		template <typename U, bool S>
 		friend struct SharedArray;
 		template <typename U> void do_sprintf(const U *format, va_list args) noexcept;
+
+		template <typename U, typename... Args> void do_format(const U *format, const Args&... args) noexcept;
+		template <typename U, bool S, typename... Args> void do_format(Slice<U, S> format, const Args&... args) noexcept;
+		template <typename F, typename... Args> auto do_format(F format, const Args&... args) noexcept -> decltype(F::format_string(), void());
+		template <typename... Items> void append_items(const Items&... items) noexcept;
+		template <typename U> auto append_item(U c, size_t) noexcept -> decltype(typename detail::IsSomeChar<U>::type(), void());
+		template <typename U> auto append_item(U value, size_t) noexcept -> decltype(typename detail::IsSomeNumber<U>::type(), void());
+		template <typename U, bool S> void append_item(Slice<U, S> s, size_t following) noexcept;
+		template <typename U> void append_item(const U *s, size_t following) noexcept;
+#if !defined(NO_STL)
+		template <class _Ty, class _Alloc> void append_item(const std::vector<_Ty, _Alloc> &vec, size_t following) noexcept;
+		template <class _Elem, class _Traits, class _Alloc> void append_item(const std::basic_string<_Elem, _Traits, _Alloc> &str, size_t following) noexcept;
+#endif
+		void append_arg(size_t) noexcept { SLICE_ASSERT(false); }
+		template <typename Item, typename... Args> void append_arg(size_t i, const Item &item, const Args&... args) noexcept;
+	};
+
+	// a format string which is parsed at compile time, for Array::format and the Format constructors
+#define SLICE_FORMAT(s) [] { struct FormatString { static constexpr decltype(s) format_string() { return s; } }; return FormatString(); }()
+
+	// arrays without local elements are just a pointer to their allocation
+	template <typename T, bool S>
+	struct TriviallyRelocatable<Array<T, 0, S>>
+	{
+		enum { value = true };
 	};
 
 	template <size_t Count = 0>
@@ -194,37 +263,581 @@ namespace beautifulcode
 			enum Flags
 			{
 				None = 0,
-				RefCounted = 1
+				Wide = 1,			// an ArrayWideHeader precedes the header, and holds the count and size instead
+				CachedHash = 2,		// an ArrayHashCache precedes the header
+				AtomicRc = 4		// an ArrayRefCount precedes the header, and counts references instead of rc
+			};
+
+			// Small headers are just the packed word, for allocations of up to MaxSmallBytes. Compact headers are preceded
+			// by a 32bit size, and Padded headers are also padded so the elements are 16 byte aligned. The header is
+			// 4 << layout bytes
+			enum Layout
+			{
+				Small = 0,
+				Compact = 1,
+				Padded = 2
+			};
+
+			// the word packs [flags:3][layout:2][allocator:3][rc:24] from the low bit up, where the allocator is the
+			// allocating module's SLICE_ALLOCATOR_ID. Only Array needs the size, and only SharedArray needs the count, so
+			// the rc of small headers holds the size while an Array owns the allocation, and the count once it's shared
+			// (see share_array). Counts saturate at ImmortalRc, and arrays which reach it are never released; larger
+			// allocations have wide headers
+			enum : uint32_t
+			{
+				LayoutShift = 3,
+				AllocatorShift = 5,
+				RcShift = 8,
+				RcOne = 1 << RcShift,
+				ImmortalRc = 0xFFFFFF00,
+				MaxSmallBytes = 255,
+				MaxBytes = 0xFFFFFFFF,
+				MaxAllocators = 8
 			};
 
 			using FreeFunc = void(void*);// noexcept; // TODO: VS2015 doesn't support this?
-			FreeFunc *freeFunc;
-			uint64_t rc : 21,
-			         bytes : 40,
-			         flags : 3;
+			uint32_t word;
+
+			Flags flags() const noexcept { return (Flags)(word & 7); }
+			Layout layout() const noexcept { return (Layout)(word >> LayoutShift & 3); }
+			unsigned allocator() const noexcept { return word >> AllocatorShift & 7; }
+		};
+		static_assert(SLICE_ALLOCATOR_ID >= 0 && SLICE_ALLOCATOR_ID < ArrayHeader::MaxAllocators, "SLICE_ALLOCATOR_ID is out of range!");
+
+		// the optional prefixes are laid out as [ArrayHashCache][ArrayWideHeader][ArrayRefCount][header][elements], and
+		// are padded to 16 bytes, so the elements are aligned by the header's layout
+
+		// 64bit reference count and size, for arrays which may be referenced more times or be larger than ArrayHeader
+		// can count
+		struct ArrayWideHeader
+		{
+			uint64_t rc;
+			uint64_t bytes;
+		};
+
+		// hash of the elements with the default seed, or 0 if it hasn't been computed
+		struct ArrayHashCache
+		{
+			uint64_t hash;
+			uint64_t padding;
 		};
 
+		// Atomic counts are kept in `shared`, with relaxed increments and acq_rel decrements, so that the thread which
+		// releases the last reference sees every other thread's writes to the elements before it destroys them. The
+		// count is held in multiples of SharedOne, above the SharedMerged and SharedQueued flags.
+		//
+		// Biased counts (Choi, Shull & Torrellas, "Biased Reference Counting", PACT 2018) give each array an owner,
+		// the thread which allocated it, which counts its own references in `biased` with plain loads and stores. The
+		// other threads count theirs in `shared`, which may go negative while the owner holds references. When the
+		// owner releases its last reference it merges the counts by setting SharedMerged, after which every thread
+		// counts in `shared` and the array is destroyed when it reaches 0. If the owner's references are released by
+		// other threads, the one which takes `shared` negative sets SharedQueued and queues the array for the owner to
+		// merge; owners merge their queue when they allocate, and when they exit, after which other threads merge for
+		// them. Arrays which are only counted atomically are merged from the start.
+		struct BiasedOwner;
+		struct ArrayRefCount
+		{
+			uint32_t shared;
+			uint32_t biased;
+			BiasedOwner *owner;
+			char padding[24 - sizeof(BiasedOwner*)];
+		};
+		enum : uint32_t { SharedMerged = 1, SharedQueued = 2, SharedOne = 4 };
+		// atomic and biased counts saturate here, well before `shared` could overflow, and the array becomes immortal
+		enum : int32_t { ImmortalCount = 1 << 28 };
+
+		// an array that has been queued for its owner to merge, and how to destroy it if no references remain
+		struct BiasedMerge
+		{
+			BiasedMerge *next;
+			const void *buffer;
+			size_t length;
+			void (*destroy)(const void *buffer, size_t length);
+		};
+		struct BiasedOwner
+		{
+			uint32_t rc;			// 1 while the thread runs, and 1 for each unmerged array it owns
+			BiasedMerge *queue;		// arrays to merge, or abandoned_queue() once the thread has exited
+		};
+
+		// counts are loaded, stored and incremented with relaxed ordering, and the other operations are acq_rel
+#if defined(_MSC_VER)
+		inline uint32_t atomic_load(const uint32_t *p) noexcept { return *(const volatile uint32_t*)p; }
+		inline void atomic_store(uint32_t *p, uint32_t value) noexcept { *(volatile uint32_t*)p = value; }
+# if defined(_M_IX86)
+		inline uint64_t atomic_load(const uint64_t *p) noexcept { return (uint64_t)_InterlockedCompareExchange64((volatile long long*)p, 0, 0); }
+		inline void atomic_store(uint64_t *p, uint64_t value) noexcept
+		{
+			long long prev = *(volatile long long*)p, cur;
+			while ((cur = _InterlockedCompareExchange64((volatile long long*)p, (long long)value, prev)) != prev)
+				prev = cur;
+		}
+# else
+		inline uint64_t atomic_load(const uint64_t *p) noexcept { return *(const volatile uint64_t*)p; }
+		inline void atomic_store(uint64_t *p, uint64_t value) noexcept { *(volatile uint64_t*)p = value; }
+# endif
+		inline uint32_t atomic_increment(uint32_t *p, uint32_t value) noexcept { return (uint32_t)_InterlockedExchangeAdd((volatile long*)p, (long)value) + value; }
+		inline uint32_t atomic_add(uint32_t *p, uint32_t value) noexcept { return (uint32_t)_InterlockedExchangeAdd((volatile long*)p, (long)value) + value; }
+		inline bool atomic_cas(uint32_t *p, uint32_t &expected, uint32_t desired) noexcept
+		{
+			uint32_t prev = (uint32_t)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)expected);
+			bool success = prev == expected;
+			expected = prev;
+			return success;
+		}
+		template <typename T>
+		inline T* atomic_load(T *const *p) noexcept { return *(T *const volatile*)p; }
+		template <typename T>
+		inline T* atomic_exchange(T **p, T *value) noexcept { return (T*)_InterlockedExchangePointer((void *volatile*)p, value); }
+		template <typename T>
+		inline bool atomic_cas(T **p, T *&expected, T *desired) noexcept
+		{
+			T *prev = (T*)_InterlockedCompareExchangePointer((void *volatile*)p, desired, expected);
+			bool success = prev == expected;
+			expected = prev;
+			return success;
+		}
+#else
+		inline uint32_t atomic_load(const uint32_t *p) noexcept { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+		inline void atomic_store(uint32_t *p, uint32_t value) noexcept { __atomic_store_n(p, value, __ATOMIC_RELAXED); }
+		inline uint64_t atomic_load(const uint64_t *p) noexcept { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+		inline void atomic_store(uint64_t *p, uint64_t value) noexcept { __atomic_store_n(p, value, __ATOMIC_RELAXED); }
+		inline uint32_t atomic_increment(uint32_t *p, uint32_t value) noexcept { return __atomic_add_fetch(p, value, __ATOMIC_RELAXED); }
+		inline uint32_t atomic_add(uint32_t *p, uint32_t value) noexcept { return __atomic_add_fetch(p, value, __ATOMIC_ACQ_REL); }
+		inline bool atomic_cas(uint32_t *p, uint32_t &expected, uint32_t desired) noexcept
+		{
+			return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+		}
+		template <typename T>
+		inline T* atomic_load(T *const *p) noexcept { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+		template <typename T>
+		inline T* atomic_exchange(T **p, T *value) noexcept { return __atomic_exchange_n(p, value, __ATOMIC_ACQ_REL); }
+		template <typename T>
+		inline bool atomic_cas(T **p, T *&expected, T *desired) noexcept
+		{
+			return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+		}
+#endif
+
+		inline int32_t shared_count(uint32_t shared) noexcept
+		{
+			return (int32_t)(shared & ~(SharedOne - 1)) / (int32_t)SharedOne;
+		}
+
+		inline size_t array_prefix_bytes(unsigned flags) noexcept
+		{
+			return (flags & ArrayHeader::CachedHash ? sizeof(ArrayHashCache) : 0) + (flags & ArrayHeader::AtomicRc ? sizeof(ArrayRefCount) : 0) +
+				(flags & ArrayHeader::Wide ? sizeof(ArrayWideHeader) : 0);
+		}
+
 		inline ArrayHeader* get_array_header(const void *buffer) noexcept
 		{
 			return (ArrayHeader*)buffer - 1;
 		}
+		inline char* get_header_start(const ArrayHeader *hdr) noexcept
+		{
+			return (char*)(hdr + 1) - ((size_t)4 << hdr->layout());
+		}
+		inline ArrayHashCache* get_hash_cache(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			return hdr->flags() & ArrayHeader::CachedHash ? (ArrayHashCache*)(get_header_start(hdr) - array_prefix_bytes(hdr->flags())) : nullptr;
+		}
+		// the hash cache of arrays which may be shared between threads is loaded and stored atomically
+		inline uint64_t load_cached_hash(const void *buffer, const ArrayHashCache *cache) noexcept
+		{
+			return get_array_header(buffer)->flags() & ArrayHeader::AtomicRc ? atomic_load(&cache->hash) : cache->hash;
+		}
+		inline void store_cached_hash(const void *buffer, ArrayHashCache *cache, uint64_t hash) noexcept
+		{
+			if (get_array_header(buffer)->flags() & ArrayHeader::AtomicRc)
+				atomic_store(&cache->hash, hash);
+			else
+				cache->hash = hash;
+		}
+		inline ArrayRefCount* get_ref_count(const ArrayHeader *hdr) noexcept
+		{
+			return (ArrayRefCount*)get_header_start(hdr) - 1;
+		}
+		inline ArrayWideHeader* get_wide_header(const ArrayHeader *hdr) noexcept
+		{
+			return (ArrayWideHeader*)(hdr->flags() & ArrayHeader::AtomicRc ? (char*)get_ref_count(hdr) : get_header_start(hdr)) - 1;
+		}
+		inline size_t array_bytes(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (hdr->flags() & ArrayHeader::Wide)
+				return (size_t)get_wide_header(hdr)->bytes;
+			return hdr->layout() == ArrayHeader::Small ? (size_t)(hdr->word >> ArrayHeader::RcShift) : (size_t)((uint32_t*)hdr)[-1];
+		}
+
+		inline bool is_immortal(const ArrayHeader *hdr) noexcept
+		{
+			return hdr->word >= ArrayHeader::ImmortalRc;
+		}
+		inline size_t header_rc(const ArrayHeader *hdr) noexcept
+		{
+			return (size_t)(hdr->word >> ArrayHeader::RcShift);
+		}
+
+		// the free function of each allocator id. Modules which don't share static data (ie, DLL's) should #define
+		// SLICE_ALLOCATOR_TABLE to name a table of ArrayHeader::MaxAllocators entries which is exported by one of them
+		inline ArrayHeader::FreeFunc** allocator_table() noexcept
+		{
+#if defined(SLICE_ALLOCATOR_TABLE)
+			return SLICE_ALLOCATOR_TABLE;
+#else
+			static ArrayHeader::FreeFunc *table[ArrayHeader::MaxAllocators] = {};
+			return table;
+#endif
+		}
+		inline void register_allocator() noexcept
+		{
+			static bool registered = (allocator_table()[SLICE_ALLOCATOR_ID] = [](void *mem) { SLICE_FREE(mem); }, true);
+			(void)registered;
+		}
+
+		inline BiasedMerge* abandoned_queue() noexcept
+		{
+			static BiasedMerge sentinel;
+			return &sentinel;
+		}
+		inline BiasedOwner*& current_biased_owner() noexcept
+		{
+			static thread_local BiasedOwner *owner = nullptr;
+			return owner;
+		}
+		inline void release_owner(BiasedOwner *owner) noexcept
+		{
+			if (!atomic_add(&owner->rc, (uint32_t)-1))
+				SLICE_FREE(owner);
+		}
+
+		// moves the biased count to the shared count, and returns the number of references
+		inline int32_t merge_ref(ArrayRefCount *rc) noexcept
+		{
+			uint32_t biased = atomic_load(&rc->biased);
+			atomic_store(&rc->biased, 0);
+			uint32_t shared = atomic_load(&rc->shared), merged;
+			do merged = ((shared + biased*SharedOne) | SharedMerged) & ~SharedQueued;
+			while (!atomic_cas(&rc->shared, shared, merged));
+			release_owner(rc->owner);
+			return shared_count(merged);
+		}
+		inline void merge_queued(BiasedMerge *queue) noexcept
+		{
+			while (queue)
+			{
+				BiasedMerge *next = queue->next;
+				if (!merge_ref(get_ref_count(get_array_header(queue->buffer))))
+					queue->destroy(queue->buffer, queue->length);
+				SLICE_FREE(queue);
+				queue = next;
+			}
+		}
+
+		// merges the thread's queue when it exits, and leaves any arrays that it still owns for other threads to merge
+		struct BiasedOwnerThread
+		{
+			~BiasedOwnerThread()
+			{
+				BiasedOwner *&owner = current_biased_owner();
+				merge_queued(atomic_exchange(&owner->queue, abandoned_queue()));
+				release_owner(owner);
+				owner = nullptr;
+			}
+		};
+		inline BiasedOwner* acquire_biased_owner() noexcept
+		{
+			BiasedOwner *&owner = current_biased_owner();
+			if (!owner)
+			{
+				static thread_local BiasedOwnerThread thread;
+				(void)thread;
+				owner = (BiasedOwner*)SLICE_ALLOC(sizeof(BiasedOwner));
+				owner->rc = 1;
+				owner->queue = nullptr;
+			}
+			else if (atomic_load(&owner->queue))
+				merge_queued(atomic_exchange(&owner->queue, (BiasedMerge*)nullptr));
+			atomic_increment(&owner->rc, 1);
+			return owner;
+		}
+
+		// the flags of allocations for elements of type T
+		template <typename T>
+		constexpr ArrayHeader::Flags array_flags() noexcept
+		{
+			return AtomicRefCount<typename std::remove_cv<T>::type>::value || BiasedRefCount<typename std::remove_cv<T>::type>::value ? ArrayHeader::AtomicRc : ArrayHeader::None;
+		}
+
+		// the header layout of allocations of `bytes` of T
+		template <typename T>
+		constexpr ArrayHeader::Layout array_layout(size_t bytes) noexcept
+		{
+			return alignof(T) > 8 ? ArrayHeader::Padded :
+				alignof(T) > 4 || bytes > ArrayHeader::MaxSmallBytes ? ArrayHeader::Compact : ArrayHeader::Small;
+		}
 
 		template <typename T>
 		inline T* alloc_array(size_t bytes, ArrayHeader::Flags flags) noexcept
 		{
-			ArrayHeader *hdr = (ArrayHeader*)SLICE_ALLOC(sizeof(ArrayHeader) + bytes);
-			hdr->freeFunc = [](void *mem) { SLICE_FREE(mem); };
-			hdr->rc = 1;
-			hdr->bytes = bytes;
-			hdr->flags = flags;
+			register_allocator();
+			if (bytes > ArrayHeader::MaxBytes)
+				flags = (ArrayHeader::Flags)(flags | ArrayHeader::Wide);
+			ArrayHeader::Layout layout = array_layout<T>(bytes);
+			size_t prefix = array_prefix_bytes(flags) + ((size_t)4 << layout);
+			ArrayHeader *hdr = (ArrayHeader*)((char*)SLICE_ALLOC(prefix + bytes) + prefix) - 1;
+			hdr->word = flags | layout << ArrayHeader::LayoutShift | SLICE_ALLOCATOR_ID << ArrayHeader::AllocatorShift;
+			if (flags & ArrayHeader::Wide)
+			{
+				get_wide_header(hdr)->rc = 1;
+				get_wide_header(hdr)->bytes = bytes;
+			}
+			else if (layout == ArrayHeader::Small)
+				hdr->word |= (uint32_t)bytes << ArrayHeader::RcShift;
+			else
+			{
+				hdr->word |= ArrayHeader::RcOne;
+				((uint32_t*)hdr)[-1] = (uint32_t)bytes;
+			}
+			if (flags & ArrayHeader::CachedHash)
+				get_hash_cache(hdr + 1)->hash = 0;
+			if (flags & ArrayHeader::AtomicRc)
+			{
+				ArrayRefCount *rc = get_ref_count(hdr);
+				if (BiasedRefCount<typename std::remove_cv<T>::type>::value)
+				{
+					rc->shared = 0;
+					rc->biased = 1;
+					rc->owner = acquire_biased_owner();
+				}
+				else
+				{
+					rc->shared = SharedOne | SharedMerged;
+					rc->biased = 0;
+					rc->owner = nullptr;
+				}
+			}
+			return (T*)(hdr + 1);
+		}
+
+		// resizes an allocation with SLICE_REALLOC, which may grow it in place. The allocation must have been made by
+		// this module's allocator, and keep its header layout, otherwise it returns null and the allocation is unchanged
+		template <typename T>
+		inline T* realloc_array(T *pArray, size_t bytes) noexcept
+		{
+#if defined(SLICE_REALLOC)
+			ArrayHeader *hdr = get_array_header(pArray);
+			ArrayHeader::Flags flags = hdr->flags();
+			if (hdr->allocator() != SLICE_ALLOCATOR_ID || array_layout<T>(bytes) != hdr->layout() ||
+				(bytes > ArrayHeader::MaxBytes && !(flags & ArrayHeader::Wide)))
+				return nullptr;
+			size_t prefix = array_prefix_bytes(flags), header = (size_t)4 << hdr->layout();
+			char *mem = (char*)SLICE_REALLOC(get_header_start(hdr) - prefix, prefix + header + bytes);
+			if (!mem)
+				return nullptr;
+			hdr = (ArrayHeader*)(mem + prefix + header) - 1;
+			if (flags & ArrayHeader::Wide)
+				get_wide_header(hdr)->bytes = bytes;
+			else if (hdr->layout() == ArrayHeader::Small)
+				hdr->word = (hdr->word & (ArrayHeader::RcOne - 1)) | (uint32_t)bytes << ArrayHeader::RcShift;
+			else
+				((uint32_t*)hdr)[-1] = (uint32_t)bytes;
 			return (T*)(hdr + 1);
+#else
+			(void)pArray; (void)bytes;
+			return nullptr;
+#endif
 		}
 
 		template <typename T>
 		inline void free_array(T *pArray) noexcept
 		{
 			ArrayHeader *hdr = get_array_header(pArray);
-			hdr->freeFunc(hdr);
+			if (hdr->flags() & ArrayHeader::AtomicRc)
+			{
+				// arrays which are freed by an Array were never merged
+				ArrayRefCount *rc = get_ref_count(hdr);
+				if (rc->owner && !(atomic_load(&rc->shared) & SharedMerged))
+					release_owner(rc->owner);
+			}
+			allocator_table()[hdr->allocator()](get_header_start(hdr) - array_prefix_bytes(hdr->flags()));
+		}
+		template <typename T>
+		inline void destroy_array(const void *buffer, size_t length) noexcept
+		{
+			for (size_t i = 0; i < length; ++i)
+				((T*)buffer)[i].~T();
+			free_array((T*)buffer);
+		}
+
+		// an allocation passes from an Array to a SharedArray, or back when it's claimed with `bytes` of elements. Small
+		// headers which count in the header word hold the size while an Array owns them, and the count while they're shared
+		inline bool counts_in_small_header(const ArrayHeader *hdr) noexcept
+		{
+			return hdr->layout() == ArrayHeader::Small && !(hdr->flags() & (ArrayHeader::AtomicRc | ArrayHeader::Wide));
+		}
+		inline void share_array(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (counts_in_small_header(hdr))
+				hdr->word = (hdr->word & (ArrayHeader::RcOne - 1)) | ArrayHeader::RcOne;
+		}
+		inline void claim_array(const void *buffer, size_t bytes) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (counts_in_small_header(hdr))
+				hdr->word = (hdr->word & (ArrayHeader::RcOne - 1)) | (uint32_t)bytes << ArrayHeader::RcShift;
+		}
+
+		// immortal arrays should be made so before they're shared with other threads; their count is reported as SIZE_MAX
+		inline void make_immortal(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (!(hdr->flags() & ArrayHeader::AtomicRc))
+			{
+				hdr->word |= ArrayHeader::ImmortalRc;
+				return;
+			}
+			ArrayRefCount *rc = get_ref_count(hdr);
+			if (rc->owner && !(atomic_load(&rc->shared) & SharedMerged))
+				release_owner(rc->owner);
+			atomic_store(&rc->biased, 0);
+			atomic_store(&rc->shared, (uint32_t)ImmortalCount*SharedOne | SharedMerged);
+		}
+
+		// the counts of arrays with biased counts which are shared between threads are approximate, but an array whose
+		// owner has yet to merge it is never counted as unreferenced, nor as uniquely referenced while it's queued
+		inline size_t ref_count(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (!(hdr->flags() & ArrayHeader::AtomicRc))
+			{
+				if (is_immortal(hdr))
+					return ~(size_t)0;
+				return hdr->flags() & ArrayHeader::Wide ? (size_t)get_wide_header(hdr)->rc : header_rc(hdr);
+			}
+			ArrayRefCount *rc = get_ref_count(hdr);
+			uint32_t shared = atomic_load(&rc->shared);
+			int64_t count = (int64_t)atomic_load(&rc->biased) + shared_count(shared) + (shared & SharedQueued ? 1 : 0);
+			return count >= ImmortalCount ? ~(size_t)0 : (size_t)count;
+		}
+		inline size_t add_atomic_ref(ArrayRefCount *rc) noexcept
+		{
+			if (rc->owner && rc->owner == current_biased_owner())
+			{
+				uint32_t biased = atomic_load(&rc->biased);
+				if (biased >= (uint32_t)ImmortalCount)
+					return ~(size_t)0;
+				if (biased)
+				{
+					atomic_store(&rc->biased, biased + 1);
+					return biased + 1;
+				}
+			}
+			if (shared_count(atomic_load(&rc->shared)) >= ImmortalCount)
+				return ~(size_t)0;
+			return (size_t)shared_count(atomic_increment(&rc->shared, SharedOne));
+		}
+		template <typename T>
+		inline size_t release_atomic_ref(ArrayRefCount *rc, T *buffer, size_t length) noexcept
+		{
+			uint32_t shared;
+			if (rc->owner && rc->owner == current_biased_owner())
+			{
+				uint32_t biased = atomic_load(&rc->biased);
+				if (biased >= (uint32_t)ImmortalCount)
+					return ~(size_t)0;
+				if (biased > 1)
+				{
+					atomic_store(&rc->biased, biased - 1);
+					return biased - 1;
+				}
+				if (biased == 1)
+				{
+					atomic_store(&rc->biased, 0);
+					shared = atomic_load(&rc->shared);
+					do
+					{
+						// the owner's queue will merge it
+						if (shared & SharedQueued)
+							return 1;
+					}
+					while (!atomic_cas(&rc->shared, shared, shared | SharedMerged));
+					release_owner(rc->owner);
+					return (size_t)shared_count(shared);
+				}
+			}
+			shared = atomic_load(&rc->shared);
+			if (shared_count(shared) >= ImmortalCount)
+				return ~(size_t)0;
+			if (shared & SharedMerged)
+				return (size_t)shared_count(atomic_add(&rc->shared, (uint32_t)-SharedOne));
+
+			uint32_t released;
+			do
+			{
+				released = shared - SharedOne;
+				if (!(shared & SharedMerged) && shared_count(released) < 0)
+					released |= SharedQueued;
+			}
+			while (!atomic_cas(&rc->shared, shared, released));
+			if (released & SharedMerged)
+				return (size_t)shared_count(released);
+			if (!(released & SharedQueued) || (shared & SharedQueued))
+				return 1;
+
+			// the owner's references were released by other threads, so queue the array for the owner to merge, or merge
+			// it here if the owner has exited
+			BiasedOwner *owner = rc->owner;
+			BiasedMerge *merge = (BiasedMerge*)SLICE_ALLOC(sizeof(BiasedMerge));
+			merge->buffer = buffer;
+			merge->length = length;
+			merge->destroy = &destroy_array<T>;
+			BiasedMerge *queue = atomic_load(&owner->queue);
+			do
+			{
+				if (queue == abandoned_queue())
+				{
+					SLICE_FREE(merge);
+					return (size_t)merge_ref(rc);
+				}
+				merge->next = queue;
+			}
+			while (!atomic_cas(&owner->queue, queue, merge));
+			return 1;
+		}
+
+		inline size_t add_ref(const void *buffer) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (!(hdr->flags() & (ArrayHeader::AtomicRc | ArrayHeader::Wide)))
+			{
+				if (is_immortal(hdr))
+					return ~(size_t)0;
+				hdr->word += ArrayHeader::RcOne;
+				return is_immortal(hdr) ? ~(size_t)0 : header_rc(hdr);
+			}
+			if (!(hdr->flags() & ArrayHeader::AtomicRc))
+				return is_immortal(hdr) ? ~(size_t)0 : (size_t)++get_wide_header(hdr)->rc;
+			return add_atomic_ref(get_ref_count(hdr));
+		}
+		// returns the number of references that remain, and 0 when the caller should destroy the array
+		template <typename T>
+		inline size_t release_ref(T *buffer, size_t length) noexcept
+		{
+			ArrayHeader *hdr = get_array_header(buffer);
+			if (!(hdr->flags() & ArrayHeader::AtomicRc))
+			{
+				if (is_immortal(hdr))
+					return ~(size_t)0;
+				if (hdr->flags() & ArrayHeader::Wide)
+					return (size_t)--get_wide_header(hdr)->rc;
+				hdr->word -= ArrayHeader::RcOne;
+				return header_rc(hdr);
+			}
+			return release_atomic_ref(get_ref_count(hdr), buffer, length);
 		}
 
 		// set of functions that count elements for appending
@@ -438,7 +1051,7 @@ namespace beautifulcode
 		size_t bytes;
 		if (hasAlloc)
 		{
-			bytes = detail::get_array_header(this->ptr)->bytes;
+			bytes = detail::array_bytes(this->ptr);
 			count *= sizeof(T);
 			// early out if there's already more than the request
 			if (count <= bytes)
@@ -451,21 +1064,25 @@ namespace beautifulcode
 			enum { InitialAlloc = Count > 8 ? Count * 2 : 16 };
 			bytes = count <= InitialAlloc ? InitialAlloc * sizeof(T) : count * sizeof(T);
 		}
-		// TODO: support realloc?
-//		if (hasAlloc)
-//		{
-//			// attempt to realloc
-//			T *mem = detail::slice_realloc<T>(this->ptr, bytes);
-//			if (mem)
-//			{
-//				this->ptr = mem;
-//				return;
-//			}
-//		}
+		enum { Relocatable = TriviallyRelocatable<typename std::remove_cv<T>::type>::value };
+		if (Relocatable && hasAlloc)
+		{
+			// grow in place where the allocator can, which large allocations usually may by remapping their pages
+			T *mem = detail::realloc_array<T>(this->ptr, bytes);
+			if (mem)
+			{
+				this->ptr = mem;
+				return;
+			}
+		}
 		// alloc new memory and copy old contents
-		T *mem = detail::alloc_array<T>(bytes, detail::ArrayHeader::None);
-		if (std::is_pod<T>::value)
-			memcpy((void*)mem, this->ptr, sizeof(T)*this->length);
+		T *mem = detail::alloc_array<T>(bytes, detail::array_flags<T>());
+		if (Relocatable)
+		{
+			// this->ptr may be null when empty, and passing null to memcpy lets the compiler assume hasAlloc
+			if (this->length)
+				memcpy((void*)mem, this->ptr, sizeof(T)*this->length);
+		}
 		else
 		{
 			for (size_t i = 0; i < this->length; ++i)
@@ -631,7 +1248,7 @@ namespace beautifulcode
 	inline Slice<T> Array<T, Count, S>::get_buffer() const noexcept
 	{
 		if (is_allocated())
-			return{ this->ptr, detail::get_array_header(this->ptr)->bytes / sizeof(T) };
+			return{ this->ptr, detail::array_bytes(this->ptr) / sizeof(T) };
 		return{ local.ptr(), Count };
 	}
 
@@ -648,11 +1265,11 @@ namespace beautifulcode
 			else
 			{
 				const C *end = str + len;
-				size_t count = 0;
+				size_t count = UtfTranscoder<sizeof(C), sizeof(T)>::count(str, end);
 				while (str < end)
 				{
 					char32_t c;
-					str += detail::utf_decode(str, &c);
+					str += detail::utf_decode(str, end, &c);
 					count += detail::utf_seq_length<T>(c);
 				}
 				return count;
@@ -660,169 +1277,755 @@ namespace beautifulcode
 		}
 		template <typename T, typename C>
 		inline size_t num_code_units(const C *c_str) noexcept
+		{
+			return num_code_units<T>(c_str, detail::strlen(c_str));
+		}
+
+		// transcodes as much of [str, end) as fits in [buffer, bufferEnd), and advances str past the input that was written
+		template <typename T, typename C>
+		inline T* transcode_some(T *buffer, T *bufferEnd, const C *&str, const C *end) noexcept
 		{
 			if (sizeof(C) == sizeof(T))
-				return strlen(c_str);
-			else
 			{
-				size_t count = 0;
-				while (*c_str)
+				ptrdiff_t n = end - str < bufferEnd - buffer ? end - str : bufferEnd - buffer;
+				// str and buffer may be null when empty
+				if (n > 0)
+					memcpy(buffer, str, (size_t)n * sizeof(T));
+				str += n;
+				return buffer + n;
+			}
+			buffer = UtfTranscoder<sizeof(C), sizeof(T)>::transcode(buffer, bufferEnd, str, end);
+
+			// the most code units that one code unit of C may transcode to
+			enum : ptrdiff_t { MaxUnits = sizeof(T) >= sizeof(C) ? 1 : (sizeof(T) == 1 ? (sizeof(C) == 2 ? 3 : 4) : 2) };
+			const uint64_t unitMax = sizeof(C) == 1 ? 0xFF : (sizeof(C) == 2 ? 0xFFFF : 0xFFFFFFFF);
+			const uint64_t notAscii = (~0ull / unitMax) * (unitMax & ~0x7Full);
+
+			// the last code point of a block may run past the end of it
+			while (end - str >= 8 && bufferEnd - buffer >= 9*MaxUnits)
+			{
+				// runs of ascii are copied 8 code units at a time
+				uint64_t words[sizeof(C)];
+				memcpy(words, str, sizeof(words));
+				uint64_t bits = 0;
+				for (size_t i = 0; i < sizeof(C); ++i)
+					bits |= words[i];
+				if (!(bits & notAscii))
+				{
+					for (int i = 0; i < 8; ++i)
+						buffer[i] = (T)str[i];
+					str += 8;
+					buffer += 8;
+					continue;
+				}
+				// otherwise there is room for the block whatever it contains
+				const C *blockEnd = str + 8;
+				while (str < blockEnd)
 				{
 					char32_t c;
-					c_str += detail::utf_decode(c_str, &c);
-					count += detail::utf_seq_length<T>(c);
+					str += utf_decode(str, end, &c);
+					buffer += utf_encode(c, buffer);
 				}
-				return count;
 			}
+			// near the end of the input or the buffer, check each code point fits
+			while (str < end)
+			{
+				char32_t c;
+				size_t n = utf_decode(str, end, &c);
+				if (utf_seq_length<T>(c) > (size_t)(bufferEnd - buffer))
+					break;
+				buffer += utf_encode(c, buffer);
+				str += n;
+			}
+			return buffer;
 		}
 
+		// transcodes a string to a buffer with room for num_code_units<T>(str, len) code units
 		template <typename T, typename C>
-		inline size_t transcode_string(T *buffer, const C *str, size_t len) noexcept
+		inline size_t transcode_string(T *buffer, size_t bufferLen, const C *str, size_t len) noexcept
 		{
-			if (sizeof(C) == sizeof(T))
+			return transcode_some(buffer, buffer + bufferLen, str, str + len) - buffer;
+		}
+
+		template <typename F> struct FloatFormat;
+		template <> struct FloatFormat<float>
+		{
+			using Bits = uint32_t;
+			enum { SignificandBits = 23, ExponentBits = 8, MaxChars = 22 };
+		};
+		template <> struct FloatFormat<double>
+		{
+			using Bits = uint64_t;
+			enum { SignificandBits = 52, ExponentBits = 11, MaxChars = 25 };
+		};
+
+		inline const char* digit_pairs() noexcept
+		{
+			return "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+				   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+				   "8081828384858687888990919293949596979899";
+		}
+
+		inline unsigned count_digits(uint64_t v) noexcept
+		{
+			static const uint64_t powers[] = {
+				1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+				10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+				1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+			};
+			v |= 1; // zero has one digit, and setting the low bit never changes the count
+			unsigned t = (bsr64(v) + 1)*1233 >> 12;
+			return t + 1 - (v < powers[t]);
+		}
+
+		// writes the decimal digits of v, two at a time, backwards from end
+		template <typename T>
+		inline void write_digits(T *end, uint64_t v) noexcept
+		{
+			const char *pairs = digit_pairs();
+			while (v >= 100)
 			{
-				memcpy(buffer, str, len * sizeof(T));
-				return len;
+				const char *d = pairs + (v % 100)*2;
+				v /= 100;
+				*--end = (T)d[1];
+				*--end = (T)d[0];
+			}
+			if (v >= 10)
+			{
+				*--end = (T)pairs[v*2 + 1];
+				*--end = (T)pairs[v*2];
+			}
+			else
+				*--end = (T)('0' + v);
+		}
+
+		template <typename T>
+		inline size_t format_uint(T *buffer, uint64_t v) noexcept
+		{
+			unsigned len = count_digits(v);
+			write_digits(buffer + len, v);
+			return len;
+		}
+
+		template <typename T>
+		inline size_t format_ascii(T *buffer, const char *s) noexcept
+		{
+			T *buf = buffer;
+			while (*s)
+				*buf++ = (T)*s++;
+			return buf - buffer;
+		}
+
+		// floor(10^p * 2^(127 - floor(log2(10^p)))) + 1 for p in [-292, 324], as pairs of 64 bit words, high first
+		inline const uint64_t* power_of_ten_128() noexcept
+		{
+			static const uint64_t table[] = {
+				0xFF77B1FCBEBCDC4F, 0x25E8E89C13BB0F7B, 0x9FAACF3DF73609B1, 0x77B191618C54E9AD,
+				0xC795830D75038C1D, 0xD59DF5B9EF6A2418, 0xF97AE3D0D2446F25, 0x4B0573286B44AD1E,
+				0x9BECCE62836AC577, 0x4EE367F9430AEC33, 0xC2E801FB244576D5, 0x229C41F793CDA740,
+				0xF3A20279ED56D48A, 0x6B43527578C11110, 0x9845418C345644D6, 0x830A13896B78AAAA,
+				0xBE5691EF416BD60C, 0x23CC986BC656D554, 0xEDEC366B11C6CB8F, 0x2CBFBE86B7EC8AA9,
+				0x94B3A202EB1C3F39, 0x7BF7D71432F3D6AA, 0xB9E08A83A5E34F07, 0xDAF5CCD93FB0CC54,
+				0xE858AD248F5C22C9, 0xD1B3400F8F9CFF69, 0x91376C36D99995BE, 0x23100809B9C21FA2,
+				0xB58547448FFFFB2D, 0xABD40A0C2832A78B, 0xE2E69915B3FFF9F9, 0x16C90C8F323F516D,
+				0x8DD01FAD907FFC3B, 0xAE3DA7D97F6792E4, 0xB1442798F49FFB4A, 0x99CD11CFDF41779D,
+				0xDD95317F31C7FA1D, 0x40405643D711D584, 0x8A7D3EEF7F1CFC52, 0x482835EA666B2573,
+				0xAD1C8EAB5EE43B66, 0xDA3243650005EED0, 0xD863B256369D4A40, 0x90BED43E40076A83,
+				0x873E4F75E2224E68, 0x5A7744A6E804A292, 0xA90DE3535AAAE202, 0x711515D0A205CB37,
+				0xD3515C2831559A83, 0x0D5A5B44CA873E04, 0x8412D9991ED58091, 0xE858790AFE9486C3,
+				0xA5178FFF668AE0B6, 0x626E974DBE39A873, 0xCE5D73FF402D98E3, 0xFB0A3D212DC81290,
+				0x80FA687F881C7F8E, 0x7CE66634BC9D0B9A, 0xA139029F6A239F72, 0x1C1FFFC1EBC44E81,
+				0xC987434744AC874E, 0xA327FFB266B56221, 0xFBE9141915D7A922, 0x4BF1FF9F0062BAA9,
+				0x9D71AC8FADA6C9B5, 0x6F773FC3603DB4AA, 0xC4CE17B399107C22, 0xCB550FB4384D21D4,
+				0xF6019DA07F549B2B, 0x7E2A53A146606A49, 0x99C102844F94E0FB, 0x2EDA7444CBFC426E,
+				0xC0314325637A1939, 0xFA911155FEFB5309, 0xF03D93EEBC589F88, 0x793555AB7EBA27CB,
+				0x96267C7535B763B5, 0x4BC1558B2F3458DF, 0xBBB01B9283253CA2, 0x9EB1AAEDFB016F17,
+				0xEA9C227723EE8BCB, 0x465E15A979C1CADD, 0x92A1958A7675175F, 0x0BFACD89EC191ECA,
+				0xB749FAED14125D36, 0xCEF980EC671F667C, 0xE51C79A85916F484, 0x82B7E12780E7401B,
+				0x8F31CC0937AE58D2, 0xD1B2ECB8B0908811, 0xB2FE3F0B8599EF07, 0x861FA7E6DCB4AA16,
+				0xDFBDCECE67006AC9, 0x67A791E093E1D49B, 0x8BD6A141006042BD, 0xE0C8BB2C5C6D24E1,
+				0xAECC49914078536D, 0x58FAE9F773886E19, 0xDA7F5BF590966848, 0xAF39A475506A899F,
+				0x888F99797A5E012D, 0x6D8406C952429604, 0xAAB37FD7D8F58178, 0xC8E5087BA6D33B84,
+				0xD5605FCDCF32E1D6, 0xFB1E4A9A90880A65, 0x855C3BE0A17FCD26, 0x5CF2EEA09A550680,
+				0xA6B34AD8C9DFC06F, 0xF42FAA48C0EA481F, 0xD0601D8EFC57B08B, 0xF13B94DAF124DA27,
+				0x823C12795DB6CE57, 0x76C53D08D6B70859, 0xA2CB1717B52481ED, 0x54768C4B0C64CA6F,
+				0xCB7DDCDDA26DA268, 0xA9942F5DCF7DFD0A, 0xFE5D54150B090B02, 0xD3F93B35435D7C4D,
+				0x9EFA548D26E5A6E1, 0xC47BC5014A1A6DB0, 0xC6B8E9B0709F109A, 0x359AB6419CA1091C,
+				0xF867241C8CC6D4C0, 0xC30163D203C94B63, 0x9B407691D7FC44F8, 0x79E0DE63425DCF1E,
+				0xC21094364DFB5636, 0x985915FC12F542E5, 0xF294B943E17A2BC4, 0x3E6F5B7B17B2939E,
+				0x979CF3CA6CEC5B5A, 0xA705992CEECF9C43, 0xBD8430BD08277231, 0x50C6FF782A838354,
+				0xECE53CEC4A314EBD, 0xA4F8BF5635246429, 0x940F4613AE5ED136, 0x871B7795E136BE9A,
+				0xB913179899F68584, 0x28E2557B59846E40, 0xE757DD7EC07426E5, 0x331AEADA2FE589D0,
+				0x9096EA6F3848984F, 0x3FF0D2C85DEF7622, 0xB4BCA50B065ABE63, 0x0FED077A756B53AA,
+				0xE1EBCE4DC7F16DFB, 0xD3E8495912C62895, 0x8D3360F09CF6E4BD, 0x64712DD7ABBBD95D,
+				0xB080392CC4349DEC, 0xBD8D794D96AACFB4, 0xDCA04777F541C567, 0xECF0D7A0FC5583A1,
+				0x89E42CAAF9491B60, 0xF41686C49DB57245, 0xAC5D37D5B79B6239, 0x311C2875C522CED6,
+				0xD77485CB25823AC7, 0x7D633293366B828C, 0x86A8D39EF77164BC, 0xAE5DFF9C02033198,
+				0xA8530886B54DBDEB, 0xD9F57F830283FDFD, 0xD267CAA862A12D66, 0xD072DF63C324FD7C,
+				0x8380DEA93DA4BC60, 0x4247CB9E59F71E6E, 0xA46116538D0DEB78, 0x52D9BE85F074E609,
+				0xCD795BE870516656, 0x67902E276C921F8C, 0x806BD9714632DFF6, 0x00BA1CD8A3DB53B7,
+				0xA086CFCD97BF97F3, 0x80E8A40ECCD228A5, 0xC8A883C0FDAF7DF0, 0x6122CD128006B2CE,
+				0xFAD2A4B13D1B5D6C, 0x796B805720085F82, 0x9CC3A6EEC6311A63, 0xCBE3303674053BB1,
+				0xC3F490AA77BD60FC, 0xBEDBFC4411068A9D, 0xF4F1B4D515ACB93B, 0xEE92FB5515482D45,
+				0x991711052D8BF3C5, 0x751BDD152D4D1C4B, 0xBF5CD54678EEF0B6, 0xD262D45A78A0635E,
+				0xEF340A98172AACE4, 0x86FB897116C87C35, 0x9580869F0E7AAC0E, 0xD45D35E6AE3D4DA1,
+				0xBAE0A846D2195712, 0x8974836059CCA10A, 0xE998D258869FACD7, 0x2BD1A438703FC94C,
+				0x91FF83775423CC06, 0x7B6306A34627DDD0, 0xB67F6455292CBF08, 0x1A3BC84C17B1D543,
+				0xE41F3D6A7377EECA, 0x20CABA5F1D9E4A94, 0x8E938662882AF53E, 0x547EB47B7282EE9D,
+				0xB23867FB2A35B28D, 0xE99E619A4F23AA44, 0xDEC681F9F4C31F31, 0x6405FA00E2EC94D5,
+				0x8B3C113C38F9F37E, 0xDE83BC408DD3DD05, 0xAE0B158B4738705E, 0x9624AB50B148D446,
+				0xD98DDAEE19068C76, 0x3BADD624DD9B0958, 0x87F8A8D4CFA417C9, 0xE54CA5D70A80E5D7,
+				0xA9F6D30A038D1DBC, 0x5E9FCF4CCD211F4D, 0xD47487CC8470652B, 0x7647C32000696720,
+				0x84C8D4DFD2C63F3B, 0x29ECD9F40041E074, 0xA5FB0A17C777CF09, 0xF468107100525891,
+				0xCF79CC9DB955C2CC, 0x7182148D4066EEB5, 0x81AC1FE293D599BF, 0xC6F14CD848405531,
+				0xA21727DB38CB002F, 0xB8ADA00E5A506A7D, 0xCA9CF1D206FDC03B, 0xA6D90811F0E4851D,
+				0xFD442E4688BD304A, 0x908F4A166D1DA664, 0x9E4A9CEC15763E2E, 0x9A598E4E043287FF,
+				0xC5DD44271AD3CDBA, 0x40EFF1E1853F29FE, 0xF7549530E188C128, 0xD12BEE59E68EF47D,
+				0x9A94DD3E8CF578B9, 0x82BB74F8301958CF, 0xC13A148E3032D6E7, 0xE36A52363C1FAF02,
+				0xF18899B1BC3F8CA1, 0xDC44E6C3CB279AC2, 0x96F5600F15A7B7E5, 0x29AB103A5EF8C0BA,
+				0xBCB2B812DB11A5DE, 0x7415D448F6B6F0E8, 0xEBDF661791D60F56, 0x111B495B3464AD22,
+				0x936B9FCEBB25C995, 0xCAB10DD900BEEC35, 0xB84687C269EF3BFB, 0x3D5D514F40EEA743,
+				0xE65829B3046B0AFA, 0x0CB4A5A3112A5113, 0x8FF71A0FE2C2E6DC, 0x47F0E785EABA72AC,
+				0xB3F4E093DB73A093, 0x59ED216765690F57, 0xE0F218B8D25088B8, 0x306869C13EC3532D,
+				0x8C974F7383725573, 0x1E414218C73A13FC, 0xAFBD2350644EEACF, 0xE5D1929EF90898FB,
+				0xDBAC6C247D62A583, 0xDF45F746B74ABF3A, 0x894BC396CE5DA772, 0x6B8BBA8C328EB784,
+				0xAB9EB47C81F5114F, 0x066EA92F3F326565, 0xD686619BA27255A2, 0xC80A537B0EFEFEBE,
+				0x8613FD0145877585, 0xBD06742CE95F5F37, 0xA798FC4196E952E7, 0x2C48113823B73705,
+				0xD17F3B51FCA3A7A0, 0xF75A15862CA504C6, 0x82EF85133DE648C4, 0x9A984D73DBE722FC,
+				0xA3AB66580D5FDAF5, 0xC13E60D0D2E0EBBB, 0xCC963FEE10B7D1B3, 0x318DF905079926A9,
+				0xFFBBCFE994E5C61F, 0xFDF17746497F7053, 0x9FD561F1FD0F9BD3, 0xFEB6EA8BEDEFA634,
+				0xC7CABA6E7C5382C8, 0xFE64A52EE96B8FC1, 0xF9BD690A1B68637B, 0x3DFDCE7AA3C673B1,
+				0x9C1661A651213E2D, 0x06BEA10CA65C084F, 0xC31BFA0FE5698DB8, 0x486E494FCFF30A63,
+				0xF3E2F893DEC3F126, 0x5A89DBA3C3EFCCFB, 0x986DDB5C6B3A76B7, 0xF89629465A75E01D,
+				0xBE89523386091465, 0xF6BBB397F1135824, 0xEE2BA6C0678B597F, 0x746AA07DED582E2D,
+				0x94DB483840B717EF, 0xA8C2A44EB4571CDD, 0xBA121A4650E4DDEB, 0x92F34D62616CE414,
+				0xE896A0D7E51E1566, 0x77B020BAF9C81D18, 0x915E2486EF32CD60, 0x0ACE1474DC1D122F,
+				0xB5B5ADA8AAFF80B8, 0x0D819992132456BB, 0xE3231912D5BF60E6, 0x10E1FFF697ED6C6A,
+				0x8DF5EFABC5979C8F, 0xCA8D3FFA1EF463C2, 0xB1736B96B6FD83B3, 0xBD308FF8A6B17CB3,
+				0xDDD0467C64BCE4A0, 0xAC7CB3F6D05DDBDF, 0x8AA22C0DBEF60EE4, 0x6BCDF07A423AA96C,
+				0xAD4AB7112EB3929D, 0x86C16C98D2C953C7, 0xD89D64D57A607744, 0xE871C7BF077BA8B8,
+				0x87625F056C7C4A8B, 0x11471CD764AD4973, 0xA93AF6C6C79B5D2D, 0xD598E40D3DD89BD0,
+				0xD389B47879823479, 0x4AFF1D108D4EC2C4, 0x843610CB4BF160CB, 0xCEDF722A585139BB,
+				0xA54394FE1EEDB8FE, 0xC2974EB4EE658829, 0xCE947A3DA6A9273E, 0x733D226229FEEA33,
+				0x811CCC668829B887, 0x0806357D5A3F5260, 0xA163FF802A3426A8, 0xCA07C2DCB0CF26F8,
+				0xC9BCFF6034C13052, 0xFC89B393DD02F0B6, 0xFC2C3F3841F17C67, 0xBBAC2078D443ACE3,
+				0x9D9BA7832936EDC0, 0xD54B944B84AA4C0E, 0xC5029163F384A931, 0x0A9E795E65D4DF12,
+				0xF64335BCF065D37D, 0x4D4617B5FF4A16D6, 0x99EA0196163FA42E, 0x504BCED1BF8E4E46,
+				0xC06481FB9BCF8D39, 0xE45EC2862F71E1D7, 0xF07DA27A82C37088, 0x5D767327BB4E5A4D,
+				0x964E858C91BA2655, 0x3A6A07F8D510F870, 0xBBE226EFB628AFEA, 0x890489F70A55368C,
+				0xEADAB0ABA3B2DBE5, 0x2B45AC74CCEA842F, 0x92C8AE6B464FC96F, 0x3B0B8BC90012929E,
+				0xB77ADA0617E3BBCB, 0x09CE6EBB40173745, 0xE55990879DDCAABD, 0xCC420A6A101D0516,
+				0x8F57FA54C2A9EAB6, 0x9FA946824A12232E, 0xB32DF8E9F3546564, 0x47939822DC96ABFA,
+				0xDFF9772470297EBD, 0x59787E2B93BC56F8, 0x8BFBEA76C619EF36, 0x57EB4EDB3C55B65B,
+				0xAEFAE51477A06B03, 0xEDE622920B6B23F2, 0xDAB99E59958885C4, 0xE95FAB368E45ECEE,
+				0x88B402F7FD75539B, 0x11DBCB0218EBB415, 0xAAE103B5FCD2A881, 0xD652BDC29F26A11A,
+				0xD59944A37C0752A2, 0x4BE76D3346F04960, 0x857FCAE62D8493A5, 0x6F70A4400C562DDC,
+				0xA6DFBD9FB8E5B88E, 0xCB4CCD500F6BB953, 0xD097AD07A71F26B2, 0x7E2000A41346A7A8,
+				0x825ECC24C873782F, 0x8ED400668C0C28C9, 0xA2F67F2DFA90563B, 0x728900802F0F32FB,
+				0xCBB41EF979346BCA, 0x4F2B40A03AD2FFBA, 0xFEA126B7D78186BC, 0xE2F610C84987BFA9,
+				0x9F24B832E6B0F436, 0x0DD9CA7D2DF4D7CA, 0xC6EDE63FA05D3143, 0x91503D1C79720DBC,
+				0xF8A95FCF88747D94, 0x75A44C6397CE912B, 0x9B69DBE1B548CE7C, 0xC986AFBE3EE11ABB,
+				0xC24452DA229B021B, 0xFBE85BADCE996169, 0xF2D56790AB41C2A2, 0xFAE27299423FB9C4,
+				0x97C560BA6B0919A5, 0xDCCD879FC967D41B, 0xBDB6B8E905CB600F, 0x5400E987BBC1C921,
+				0xED246723473E3813, 0x290123E9AAB23B69, 0x9436C0760C86E30B, 0xF9A0B6720AAF6522,
+				0xB94470938FA89BCE, 0xF808E40E8D5B3E6A, 0xE7958CB87392C2C2, 0xB60B1D1230B20E05,
+				0x90BD77F3483BB9B9, 0xB1C6F22B5E6F48C3, 0xB4ECD5F01A4AA828, 0x1E38AEB6360B1AF4,
+				0xE2280B6C20DD5232, 0x25C6DA63C38DE1B1, 0x8D590723948A535F, 0x579C487E5A38AD0F,
+				0xB0AF48EC79ACE837, 0x2D835A9DF0C6D852, 0xDCDB1B2798182244, 0xF8E431456CF88E66,
+				0x8A08F0F8BF0F156B, 0x1B8E9ECB641B5900, 0xAC8B2D36EED2DAC5, 0xE272467E3D222F40,
+				0xD7ADF884AA879177, 0x5B0ED81DCC6ABB10, 0x86CCBB52EA94BAEA, 0x98E947129FC2B4EA,
+				0xA87FEA27A539E9A5, 0x3F2398D747B36225, 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAE,
+				0x83A3EEEEF9153E89, 0x1953CF68300424AD, 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD8,
+				0xCDB02555653131B6, 0x3792F412CB06794E, 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD1,
+				0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC5, 0xC8DE047564D20A8B, 0xF245825A5A445276,
+				0xFB158592BE068D2E, 0xEED6E2F0F0D56713, 0x9CED737BB6C4183D, 0x55464DD69685606C,
+				0xC428D05AA4751E4C, 0xAA97E14C3C26B887, 0xF53304714D9265DF, 0xD53DD99F4B3066A9,
+				0x993FE2C6D07B7FAB, 0xE546A8038EFE402A, 0xBF8FDB78849A5F96, 0xDE98520472BDD034,
+				0xEF73D256A5C0F77C, 0x963E66858F6D4441, 0x95A8637627989AAD, 0xDDE7001379A44AA9,
+				0xBB127C53B17EC159, 0x5560C018580D5D53, 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A7,
+				0x9226712162AB070D, 0xCAB3961304CA70E9, 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D23,
+				0xE45C10C42A2B3B05, 0x8CB89A7DB77C506B, 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB243,
+				0xB267ED1940F1C61C, 0x55F038B237591ED4, 0xDF01E85F912E37A3, 0x6B6C46DEC52F6689,
+				0x8B61313BBABCE2C6, 0x2323AC4B3B3DA016, 0xAE397D8AA96C1B77, 0xABEC975E0A0D081B,
+				0xD9C7DCED53C72255, 0x96E7BD358C904A22, 0x881CEA14545C7575, 0x7E50D64177DA2E55,
+				0xAA242499697392D2, 0xDDE50BD1D5D0B9EA, 0xD4AD2DBFC3D07787, 0x955E4EC64B44E865,
+				0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113F, 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58F,
+				0xCFB11EAD453994BA, 0x67DE18EDA5814AF3, 0x81CEB32C4B43FCF4, 0x80EACF948770CED8,
+				0xA2425FF75E14FC31, 0xA1258379A94D028E, 0xCAD2F7F5359A3B3E, 0x096EE45813A04331,
+				0xFD87B5F28300CA0D, 0x8BCA9D6E188853FD, 0x9E74D1B791E07E48, 0x775EA264CF55347E,
+				0xC612062576589DDA, 0x95364AFE032A819E, 0xF79687AED3EEC551, 0x3A83DDBD83F52205,
+				0x9ABE14CD44753B52, 0xC4926A9672793543, 0xC16D9A0095928A27, 0x75B7053C0F178294,
+				0xF1C90080BAF72CB1, 0x5324C68B12DD6339, 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04,
+				0xBCE5086492111AEA, 0x88F4BB1CA6BCF585, 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6,
+				0x9392EE8E921D5D07, 0x3AFF322E62439FD0, 0xB877AA3236A4B449, 0x09BEFEB9FAD487C3,
+				0xE69594BEC44DE15B, 0x4C2EBE687989A9B4, 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11,
+				0xB424DC35095CD80F, 0x538484C19EF38C95, 0xE12E13424BB40E13, 0x2865A5F206B06FBA,
+				0x8CBCCC096F5088CB, 0xF93F87B7442E45D4, 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749,
+				0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C, 0x89705F4136B4A597, 0x31680A88F8953031,
+				0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E, 0xD6BF94D5E57A42BC, 0x3D32907604691B4D,
+				0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110, 0xA7C5AC471B478423, 0x0FCF80DC33721D54,
+				0xD1B71758E219652B, 0xD3C36113404EA4A9, 0x83126E978D4FDF3B, 0x645A1CAC083126EA,
+				0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4, 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD,
+				0x8000000000000000, 0x0000000000000001, 0xA000000000000000, 0x0000000000000001,
+				0xC800000000000000, 0x0000000000000001, 0xFA00000000000000, 0x0000000000000001,
+				0x9C40000000000000, 0x0000000000000001, 0xC350000000000000, 0x0000000000000001,
+				0xF424000000000000, 0x0000000000000001, 0x9896800000000000, 0x0000000000000001,
+				0xBEBC200000000000, 0x0000000000000001, 0xEE6B280000000000, 0x0000000000000001,
+				0x9502F90000000000, 0x0000000000000001, 0xBA43B74000000000, 0x0000000000000001,
+				0xE8D4A51000000000, 0x0000000000000001, 0x9184E72A00000000, 0x0000000000000001,
+				0xB5E620F480000000, 0x0000000000000001, 0xE35FA931A0000000, 0x0000000000000001,
+				0x8E1BC9BF04000000, 0x0000000000000001, 0xB1A2BC2EC5000000, 0x0000000000000001,
+				0xDE0B6B3A76400000, 0x0000000000000001, 0x8AC7230489E80000, 0x0000000000000001,
+				0xAD78EBC5AC620000, 0x0000000000000001, 0xD8D726B7177A8000, 0x0000000000000001,
+				0x878678326EAC9000, 0x0000000000000001, 0xA968163F0A57B400, 0x0000000000000001,
+				0xD3C21BCECCEDA100, 0x0000000000000001, 0x84595161401484A0, 0x0000000000000001,
+				0xA56FA5B99019A5C8, 0x0000000000000001, 0xCECB8F27F4200F3A, 0x0000000000000001,
+				0x813F3978F8940984, 0x4000000000000001, 0xA18F07D736B90BE5, 0x5000000000000001,
+				0xC9F2C9CD04674EDE, 0xA400000000000001, 0xFC6F7C4045812296, 0x4D00000000000001,
+				0x9DC5ADA82B70B59D, 0xF020000000000001, 0xC5371912364CE305, 0x6C28000000000001,
+				0xF684DF56C3E01BC6, 0xC732000000000001, 0x9A130B963A6C115C, 0x3C7F400000000001,
+				0xC097CE7BC90715B3, 0x4B9F100000000001, 0xF0BDC21ABB48DB20, 0x1E86D40000000001,
+				0x96769950B50D88F4, 0x1314448000000001, 0xBC143FA4E250EB31, 0x17D955A000000001,
+				0xEB194F8E1AE525FD, 0x5DCFAB0800000001, 0x92EFD1B8D0CF37BE, 0x5AA1CAE500000001,
+				0xB7ABC627050305AD, 0xF14A3D9E40000001, 0xE596B7B0C643C719, 0x6D9CCD05D0000001,
+				0x8F7E32CE7BEA5C6F, 0xE4820023A2000001, 0xB35DBF821AE4F38B, 0xDDA2802C8A800001,
+				0xE0352F62A19E306E, 0xD50B2037AD200001, 0x8C213D9DA502DE45, 0x4526F422CC340001,
+				0xAF298D050E4395D6, 0x9670B12B7F410001, 0xDAF3F04651D47B4C, 0x3C0CDD765F114001,
+				0x88D8762BF324CD0F, 0xA5880A69FB6AC801, 0xAB0E93B6EFEE0053, 0x8EEA0D047A457A01,
+				0xD5D238A4ABE98068, 0x72A4904598D6D881, 0x85A36366EB71F041, 0x47A6DA2B7F864751,
+				0xA70C3C40A64E6C51, 0x999090B65F67D925, 0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6E,
+				0x82818F1281ED449F, 0xBFF8F10E7A8921A5, 0xA321F2D7226895C7, 0xAFF72D52192B6A0E,
+				0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764491, 0xFEE50B7025C36A08, 0x02F236D04753D5B5,
+				0x9F4F2726179A2245, 0x01D762422C946591, 0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF6,
+				0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB3, 0x9B934C3B330C8577, 0x63CC55F49F88EB30,
+				0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FC, 0xF316271C7FC3908A, 0x8BEF464E3945EF7B,
+				0x97EDD871CFDA3A56, 0x97758BF0E3CBB5AD, 0xBDE94E8E43D0C8EC, 0x3D52EEED1CBEA318,
+				0xED63A231D4C4FB27, 0x4CA7AAA863EE4BDE, 0x945E455F24FB1CF8, 0x8FE8CAA93E74EF6B,
+				0xB975D6B6EE39E436, 0xB3E2FD538E122B45, 0xE7D34C64A9C85D44, 0x60DBBCA87196B617,
+				0x90E40FBEEA1D3A4A, 0xBC8955E946FE31CE, 0xB51D13AEA4A488DD, 0x6BABAB6398BDBE42,
+				0xE264589A4DCDAB14, 0xC696963C7EED2DD2, 0x8D7EB76070A08AEC, 0xFC1E1DE5CF543CA3,
+				0xB0DE65388CC8ADA8, 0x3B25A55F43294BCC, 0xDD15FE86AFFAD912, 0x49EF0EB713F39EBF,
+				0x8A2DBF142DFCC7AB, 0x6E3569326C784338, 0xACB92ED9397BF996, 0x49C2C37F07965405,
+				0xD7E77A8F87DAF7FB, 0xDC33745EC97BE907, 0x86F0AC99B4E8DAFD, 0x69A028BB3DED71A4,
+				0xA8ACD7C0222311BC, 0xC40832EA0D68CE0D, 0xD2D80DB02AABD62B, 0xF50A3FA490C30191,
+				0x83C7088E1AAB65DB, 0x792667C6DA79E0FB, 0xA4B8CAB1A1563F52, 0x577001B891185939,
+				0xCDE6FD5E09ABCF26, 0xED4C0226B55E6F87, 0x80B05E5AC60B6178, 0x544F8158315B05B5,
+				0xA0DC75F1778E39D6, 0x696361AE3DB1C722, 0xC913936DD571C84C, 0x03BC3A19CD1E38EA,
+				0xFB5878494ACE3A5F, 0x04AB48A04065C724, 0x9D174B2DCEC0E47B, 0x62EB0D64283F9C77,
+				0xC45D1DF942711D9A, 0x3BA5D0BD324F8395, 0xF5746577930D6500, 0xCA8F44EC7EE3647A,
+				0x9968BF6ABBE85F20, 0x7E998B13CF4E1ECC, 0xBFC2EF456AE276E8, 0x9E3FEDD8C321A67F,
+				0xEFB3AB16C59B14A2, 0xC5CFE94EF3EA101F, 0x95D04AEE3B80ECE5, 0xBBA1F1D158724A13,
+				0xBB445DA9CA61281F, 0x2A8A6E45AE8EDC98, 0xEA1575143CF97226, 0xF52D09D71A3293BE,
+				0x924D692CA61BE758, 0x593C2626705F9C57, 0xB6E0C377CFA2E12E, 0x6F8B2FB00C77836D,
+				0xE498F455C38B997A, 0x0B6DFB9C0F956448, 0x8EDF98B59A373FEC, 0x4724BD4189BD5EAD,
+				0xB2977EE300C50FE7, 0x58EDEC91EC2CB658, 0xDF3D5E9BC0F653E1, 0x2F2967B66737E3EE,
+				0x8B865B215899F46C, 0xBD79E0D20082EE75, 0xAE67F1E9AEC07187, 0xECD8590680A3AA12,
+				0xDA01EE641A708DE9, 0xE80E6F4820CC9496, 0x884134FE908658B2, 0x3109058D147FDCDE,
+				0xAA51823E34A7EEDE, 0xBD4B46F0599FD416, 0xD4E5E2CDC1D1EA96, 0x6C9E18AC7007C91B,
+				0x850FADC09923329E, 0x03E2CF6BC604DDB1, 0xA6539930BF6BFF45, 0x84DB8346B786151D,
+				0xCFE87F7CEF46FF16, 0xE612641865679A64, 0x81F14FAE158C5F6E, 0x4FCB7E8F3F60C07F,
+				0xA26DA3999AEF7749, 0xE3BE5E330F38F09E, 0xCB090C8001AB551C, 0x5CADF5BFD3072CC6,
+				0xFDCB4FA002162A63, 0x73D9732FC7C8F7F7, 0x9E9F11C4014DDA7E, 0x2867E7FDDCDD9AFB,
+				0xC646D63501A1511D, 0xB281E1FD541501B9, 0xF7D88BC24209A565, 0x1F225A7CA91A4227,
+				0x9AE757596946075F, 0x3375788DE9B06959, 0xC1A12D2FC3978937, 0x0052D6B1641C83AF,
+				0xF209787BB47D6B84, 0xC0678C5DBD23A49B, 0x9745EB4D50CE6332, 0xF840B7BA963646E1,
+				0xBD176620A501FBFF, 0xB650E5A93BC3D899, 0xEC5D3FA8CE427AFF, 0xA3E51F138AB4CEBF,
+				0x93BA47C980E98CDF, 0xC66F336C36B10138, 0xB8A8D9BBE123F017, 0xB80B0047445D4185,
+				0xE6D3102AD96CEC1D, 0xA60DC059157491E6, 0x9043EA1AC7E41392, 0x87C89837AD68DB30,
+				0xB454E4A179DD1877, 0x29BABE4598C311FC, 0xE16A1DC9D8545E94, 0xF4296DD6FEF3D67B,
+				0x8CE2529E2734BB1D, 0x1899E4A65F58660D, 0xB01AE745B101E9E4, 0x5EC05DCFF72E7F90,
+				0xDC21A1171D42645D, 0x76707543F4FA1F74, 0x899504AE72497EBA, 0x6A06494A791C53A9,
+				0xABFA45DA0EDBDE69, 0x0487DB9D17636893, 0xD6F8D7509292D603, 0x45A9D2845D3C42B7,
+				0x865B86925B9BC5C2, 0x0B8A2392BA45A9B3, 0xA7F26836F282B732, 0x8E6CAC7768D7141F,
+				0xD1EF0244AF2364FF, 0x3207D795430CD927, 0x8335616AED761F1F, 0x7F44E6BD49E807B9,
+				0xA402B9C5A8D3A6E7, 0x5F16206C9C6209A7, 0xCD036837130890A1, 0x36DBA887C37A8C10,
+				0x802221226BE55A64, 0xC2494954DA2C978A, 0xA02AA96B06DEB0FD, 0xF2DB9BAA10B7BD6D,
+				0xC83553C5C8965D3D, 0x6F92829494E5ACC8, 0xFA42A8B73ABBF48C, 0xCB772339BA1F17FA,
+				0x9C69A97284B578D7, 0xFF2A760414536EFC, 0xC38413CF25E2D70D, 0xFEF5138519684ABB,
+				0xF46518C2EF5B8CD1, 0x7EB258665FC25D6A, 0x98BF2F79D5993802, 0xEF2F773FFBD97A62,
+				0xBEEEFB584AFF8603, 0xAAFB550FFACFD8FB, 0xEEAABA2E5DBF6784, 0x95BA2A53F983CF39,
+				0x952AB45CFA97A0B2, 0xDD945A747BF26184, 0xBA756174393D88DF, 0x94F971119AEEF9E5,
+				0xE912B9D1478CEB17, 0x7A37CD5601AAB85E, 0x91ABB422CCB812EE, 0xAC62E055C10AB33B,
+				0xB616A12B7FE617AA, 0x577B986B314D600A, 0xE39C49765FDF9D94, 0xED5A7E85FDA0B80C,
+				0x8E41ADE9FBEBC27D, 0x14588F13BE847308, 0xB1D219647AE6B31C, 0x596EB2D8AE258FC9,
+				0xDE469FBD99A05FE3, 0x6FCA5F8ED9AEF3BC, 0x8AEC23D680043BEE, 0x25DE7BB9480D5855,
+				0xADA72CCC20054AE9, 0xAF561AA79A10AE6B, 0xD910F7FF28069DA4, 0x1B2BA1518094DA05,
+				0x87AA9AFF79042286, 0x90FB44D2F05D0843, 0xA99541BF57452B28, 0x353A1607AC744A54,
+				0xD3FA922F2D1675F2, 0x42889B8997915CE9, 0x847C9B5D7C2E09B7, 0x69956135FEBADA12,
+				0xA59BC234DB398C25, 0x43FAB9837E699096, 0xCF02B2C21207EF2E, 0x94F967E45E03F4BC,
+				0x8161AFB94B44F57D, 0x1D1BE0EEBAC278F6, 0xA1BA1BA79E1632DC, 0x6462D92A69731733,
+				0xCA28A291859BBF93, 0x7D7B8F7503CFDCFF, 0xFCB2CB35E702AF78, 0x5CDA735244C3D43F,
+				0x9DEFBF01B061ADAB, 0x3A0888136AFA64A8, 0xC56BAEC21C7A1916, 0x088AAA1845B8FDD1,
+				0xF6C69A72A3989F5B, 0x8AAD549E57273D46, 0x9A3C2087A63F6399, 0x36AC54E2F678864C,
+				0xC0CB28A98FCF3C7F, 0x84576A1BB416A7DE, 0xF0FDF2D3F3C30B9F, 0x656D44A2A11C51D6,
+				0x969EB7C47859E743, 0x9F644AE5A4B1B326, 0xBC4665B596706114, 0x873D5D9F0DDE1FEF,
+				0xEB57FF22FC0C7959, 0xA90CB506D155A7EB, 0x9316FF75DD87CBD8, 0x09A7F12442D588F3,
+				0xB7DCBF5354E9BECE, 0x0C11ED6D538AEB30, 0xE5D3EF282A242E81, 0x8F1668C8A86DA5FB,
+				0x8FA475791A569D10, 0xF96E017D694487BD, 0xB38D92D760EC4455, 0x37C981DCC395A9AD,
+				0xE070F78D3927556A, 0x85BBE253F47B1418, 0x8C469AB843B89562, 0x93956D7478CCEC8F,
+				0xAF58416654A6BABB, 0x387AC8D1970027B3, 0xDB2E51BFE9D0696A, 0x06997B05FCC0319F,
+				0x88FCF317F22241E2, 0x441FECE3BDF81F04, 0xAB3C2FDDEEAAD25A, 0xD527E81CAD7626C4,
+				0xD60B3BD56A5586F1, 0x8A71E223D8D3B075, 0x85C7056562757456, 0xF6872D5667844E4A,
+				0xA738C6BEBB12D16C, 0xB428F8AC016561DC, 0xD106F86E69D785C7, 0xE13336D701BEBA53,
+				0x82A45B450226B39C, 0xECC0024661173474, 0xA34D721642B06084, 0x27F002D7F95D0191,
+				0xCC20CE9BD35C78A5, 0x31EC038DF7B441F5, 0xFF290242C83396CE, 0x7E67047175A15272,
+				0x9F79A169BD203E41, 0x0F0062C6E984D387, 0xC75809C42C684DD1, 0x52C07B78A3E60869,
+				0xF92E0C3537826145, 0xA7709A56CCDF8A83, 0x9BBCC7A142B17CCB, 0x88A66076400BB692,
+				0xC2ABF989935DDBFE, 0x6ACFF893D00EA436, 0xF356F7EBF83552FE, 0x0583F6B8C4124D44,
+				0x98165AF37B2153DE, 0xC3727A337A8B704B, 0xBE1BF1B059E9A8D6, 0x744F18C0592E4C5D,
+				0xEDA2EE1C7064130C, 0x1162DEF06F79DF74, 0x9485D4D1C63E8BE7, 0x8ADDCB5645AC2BA9,
+				0xB9A74A0637CE2EE1, 0x6D953E2BD7173693, 0xE8111C87C5C1BA99, 0xC8FA8DB6CCDD0438,
+				0x910AB1D4DB9914A0, 0x1D9C9892400A22A3, 0xB54D5E4A127F59C8, 0x2503BEB6D00CAB4C,
+				0xE2A0B5DC971F303A, 0x2E44AE64840FD61E, 0x8DA471A9DE737E24, 0x5CEAECFED289E5D3,
+				0xB10D8E1456105DAD, 0x7425A83E872C5F48, 0xDD50F1996B947518, 0xD12F124E28F7771A,
+				0x8A5296FFE33CC92F, 0x82BD6B70D99AAA70, 0xACE73CBFDC0BFB7B, 0x636CC64D1001550C,
+				0xD8210BEFD30EFA5A, 0x3C47F7E05401AA4F, 0x8714A775E3E95C78, 0x65ACFAEC34810A72,
+				0xA8D9D1535CE3B396, 0x7F1839A741A14D0E, 0xD31045A8341CA07C, 0x1EDE48111209A051,
+				0x83EA2B892091E44D, 0x934AED0AAB460433, 0xA4E4B66B68B65D60, 0xF81DA84D56178540,
+				0xCE1DE40642E3F4B9, 0x36251260AB9D668F, 0x80D2AE83E9CE78F3, 0xC1D72B7C6B42601A,
+				0xA1075A24E4421730, 0xB24CF65B8612F820, 0xC94930AE1D529CFC, 0xDEE033F26797B628,
+				0xFB9B7CD9A4A7443C, 0x169840EF017DA3B2, 0x9D412E0806E88AA5, 0x8E1F289560EE864F,
+				0xC491798A08A2AD4E, 0xF1A6F2BAB92A27E3, 0xF5B5D7EC8ACB58A2, 0xAE10AF696774B1DC,
+				0x9991A6F3D6BF1765, 0xACCA6DA1E0A8EF2A, 0xBFF610B0CC6EDD3F, 0x17FD090A58D32AF4,
+				0xEFF394DCFF8A948E, 0xDDFC4B4CEF07F5B1, 0x95F83D0A1FB69CD9, 0x4ABDAF101564F98F,
+				0xBB764C4CA7A4440F, 0x9D6D1AD41ABE37F2, 0xEA53DF5FD18D5513, 0x84C86189216DC5EE,
+				0x92746B9BE2F8552C, 0x32FD3CF5B4E49BB5, 0xB7118682DBB66A77, 0x3FBC8C33221DC2A2,
+				0xE4D5E82392A40515, 0x0FABAF3FEAA5334B, 0x8F05B1163BA6832D, 0x29CB4D87F2A7400F,
+				0xB2C71D5BCA9023F8, 0x743E20E9EF511013, 0xDF78E4B2BD342CF6, 0x914DA9246B255417,
+				0x8BAB8EEFB6409C1A, 0x1AD089B6C2F7548F, 0xAE9672ABA3D0C320, 0xA184AC2473B529B2,
+				0xDA3C0F568CC4F3E8, 0xC9E5D72D90A2741F, 0x8865899617FB1871, 0x7E2FA67C7A658893,
+				0xAA7EEBFB9DF9DE8D, 0xDDBB901B98FEEAB8, 0xD51EA6FA85785631, 0x552A74227F3EA566,
+				0x8533285C936B35DE, 0xD53A88958F872760, 0xA67FF273B8460356, 0x8A892ABAF368F138,
+				0xD01FEF10A657842C, 0x2D2B7569B0432D86, 0x8213F56A67F6B29B, 0x9C3B29620E29FC74,
+				0xA298F2C501F45F42, 0x8349F3BA91B47B90, 0xCB3F2F7642717713, 0x241C70A936219A74,
+				0xFE0EFB53D30DD4D7, 0xED238CD383AA0111, 0x9EC95D1463E8A506, 0xF4363804324A40AB,
+				0xC67BB4597CE2CE48, 0xB143C6053EDCD0D6, 0xF81AA16FDC1B81DA, 0xDD94B7868E94050B,
+				0x9B10A4E5E9913128, 0xCA7CF2B4191C8327, 0xC1D4CE1F63F57D72, 0xFD1C2F611F63A3F1,
+				0xF24A01A73CF2DCCF, 0xBC633B39673C8CED, 0x976E41088617CA01, 0xD5BE0503E085D814,
+				0xBD49D14AA79DBC82, 0x4B2D8644D8A74E19, 0xEC9C459D51852BA2, 0xDDF8E7D60ED1219F,
+				0x93E1AB8252F33B45, 0xCABB90E5C942B504, 0xB8DA1662E7B00A17, 0x3D6A751F3B936244,
+				0xE7109BFBA19C0C9D, 0x0CC512670A783AD5, 0x906A617D450187E2, 0x27FB2B80668B24C6,
+				0xB484F9DC9641E9DA, 0xB1F9F660802DEDF7, 0xE1A63853BBD26451, 0x5E7873F8A0396974,
+				0x8D07E33455637EB2, 0xDB0B487B6423E1E9, 0xB049DC016ABC5E5F, 0x91CE1A9A3D2CDA63,
+				0xDC5C5301C56B75F7, 0x7641A140CC7810FC, 0x89B9B3E11B6329BA, 0xA9E904C87FCB0A9E,
+				0xAC2820D9623BF429, 0x546345FA9FBDCD45, 0xD732290FBACAF133, 0xA97C177947AD4096,
+				0x867F59A9D4BED6C0, 0x49ED8EABCCCC485E, 0xA81F301449EE8C70, 0x5C68F256BFFF5A75,
+				0xD226FC195C6A2F8C, 0x73832EEC6FFF3112, 0x83585D8FD9C25DB7, 0xC831FD53C5FF7EAC,
+				0xA42E74F3D032F525, 0xBA3E7CA8B77F5E56, 0xCD3A1230C43FB26F, 0x28CE1BD2E55F35EC,
+				0x80444B5E7AA7CF85, 0x7980D163CF5B81B4, 0xA0555E361951C366, 0xD7E105BCC3326220,
+				0xC86AB5C39FA63440, 0x8DD9472BF3FEFAA8, 0xFA856334878FC150, 0xB14F98F6F0FEB952,
+				0x9C935E00D4B9D8D2, 0x6ED1BF9A569F33D4, 0xC3B8358109E84F07, 0x0A862F80EC4700C9,
+				0xF4A642E14C6262C8, 0xCD27BB612758C0FB, 0x98E7E9CCCFBD7DBD, 0x8038D51CB897789D,
+				0xBF21E44003ACDD2C, 0xE0470A63E6BD56C4, 0xEEEA5D5004981478, 0x1858CCFCE06CAC75,
+				0x95527A5202DF0CCB, 0x0F37801E0C43EBC9, 0xBAA718E68396CFFD, 0xD30560258F54E6BB,
+				0xE950DF20247C83FD, 0x47C6B82EF32A206A, 0x91D28B7416CDD27E, 0x4CDC331D57FA5442,
+				0xB6472E511C81471D, 0xE0133FE4ADF8E953, 0xE3D8F9E563A198E5, 0x58180FDDD97723A7,
+				0x8E679C2F5E44FF8F, 0x570F09EAA7EA7649, 0xB201833B35D63F73, 0x2CD2CC6551E513DB,
+				0xDE81E40A034BCF4F, 0xF8077F7EA65E58D2, 0x8B112E86420F6191, 0xFB04AFAF27FAF783,
+				0xADD57A27D29339F6, 0x79C5DB9AF1F9B564, 0xD94AD8B1C7380874, 0x18375281AE7822BD,
+				0x87CEC76F1C830548, 0x8F2293910D0B15B6, 0xA9C2794AE3A3C69A, 0xB2EB3875504DDB23,
+				0xD433179D9C8CB841, 0x5FA60692A46151EC, 0x849FEEC281D7F328, 0xDBC7C41BA6BCD334,
+				0xA5C7EA73224DEFF3, 0x12B9B522906C0801, 0xCF39E50FEAE16BEF, 0xD768226B34870A01,
+				0x81842F29F2CCE375, 0xE6A1158300D46641, 0xA1E53AF46F801C53, 0x60495AE3C1097FD1,
+				0xCA5E89B18B602368, 0x385BB19CB14BDFC5, 0xFCF62C1DEE382C42, 0x46729E03DD9ED7B6,
+				0x9E19DB92B4E31BA9, 0x6C07A2C26A8346D2,
+			};
+			return table;
+		}
+
+		inline uint64_t round_to_odd(const uint64_t *g, uint64_t cp) noexcept
+		{
+			uint64_t x1, y1;
+			mul_64x64(g[1], cp, x1);
+			uint64_t y0 = mul_64x64(g[0], cp, y1);
+			uint64_t z = y0 + x1;
+			y1 += z < y0;
+			return y1 | (z > 1);
+		}
+
+		struct DecimalFloat
+		{
+			uint64_t digits;
+			int exponent;
+		};
+
+		// the shortest decimal which rounds to the given finite non-zero float, using Giulietti's Schubfach algorithm
+		template <typename F>
+		inline DecimalFloat shortest_decimal(uint64_t bits) noexcept
+		{
+			enum { SignificandBits = FloatFormat<F>::SignificandBits, ExponentBits = FloatFormat<F>::ExponentBits };
+			const uint64_t hidden = (uint64_t)1 << SignificandBits;
+			const int bias = (1 << (ExponentBits - 1)) - 1 + SignificandBits;
+
+			uint64_t m = bits & (hidden - 1);
+			int e = (int)(bits >> SignificandBits) & ((1 << ExponentBits) - 1);
+			uint64_t c;
+			int q;
+			if (e)
+			{
+				c = hidden | m;
+				q = e - bias;
+				// integers with no fractional bits are exact
+				if (q <= 0 && -q <= SignificandBits && (c & (((uint64_t)1 << -q) - 1)) == 0)
+					return { c >> -q, 0 };
 			}
 			else
 			{
-				const C *end = str + len;
-				T *buf = buffer;
-				while (str < end)
-				{
-					char32_t c;
-					str += detail::utf_decode(str, &c);
-					buf += detail::utf_encode(c, buf);
-				}
-				return buf - buffer;
+				c = m;
+				q = 1 - bias;
 			}
+
+			bool even = (c & 1) == 0;
+			bool lowerCloser = m == 0 && e > 1;
+			uint64_t cbl = 4*c - 2 + lowerCloser;
+			uint64_t cb = 4*c;
+			uint64_t cbr = 4*c + 2;
+
+			int k = (q*1262611 - (lowerCloser ? 524031 : 0)) >> 22;
+			int h = q + ((-k*1741647) >> 19) + 1;
+			const uint64_t *g = power_of_ten_128() + 2*(292 - k);
+			uint64_t vbl = round_to_odd(g, cbl << h);
+			uint64_t vb = round_to_odd(g, cb << h);
+			uint64_t vbr = round_to_odd(g, cbr << h);
+			uint64_t lower = vbl + !even;
+			uint64_t upper = vbr - !even;
+
+			uint64_t s = vb / 4;
+			if (s >= 10)
+			{
+				uint64_t sp = s / 10;
+				bool upInside = lower <= 40*sp;
+				bool wpInside = 40*sp + 40 <= upper;
+				if (upInside != wpInside)
+					return { sp + wpInside, k + 1 };
+			}
+			bool uInside = lower <= 4*s;
+			bool wInside = 4*s + 4 <= upper;
+			if (uInside != wInside)
+				return { s + wInside, k };
+
+			uint64_t mid = 4*s + 2;
+			bool roundUp = vb > mid || (vb == mid && (s & 1) != 0);
+			return { s + roundUp, k };
 		}
 
-		template <typename T, typename C>
-		inline size_t transcode_string(T *buffer, const C *str) noexcept
+		// writes digits*10^exponent like javascript does; positional notation for magnitudes in [1e-6, 1e21), exponential otherwise
+		template <typename T>
+		inline size_t format_decimal(T *buffer, uint64_t digits, int exponent) noexcept
 		{
-			if (sizeof(C) == sizeof(T))
+			while (digits % 10 == 0)
+			{
+				digits /= 10;
+				++exponent;
+			}
+			T *p = buffer;
+			int n = (int)count_digits(digits);
+			int point = n + exponent;
+			if (exponent >= 0 && point <= 21)
+			{
+				write_digits(p + n, digits);
+				p += n;
+				for (int i = 0; i < exponent; ++i)
+					*p++ = '0';
+			}
+			else if (point > 0 && point <= 21)
+			{
+				write_digits(p + n + 1, digits);
+				for (int i = 0; i < point; ++i)
+					p[i] = p[i + 1];
+				p[point] = '.';
+				p += n + 1;
+			}
+			else if (point > -6 && point <= 0)
 			{
-				strcpy(buffer, str);
-				return detail::strlen(str); // TODO: we really need to avoid 2 passes over the string!
+				*p++ = '0';
+				*p++ = '.';
+				for (int i = point; i < 0; ++i)
+					*p++ = '0';
+				write_digits(p + n, digits);
+				p += n;
 			}
 			else
 			{
-				T *buf = buffer;
-				while (*str)
+				write_digits(p + n + 1, digits);
+				p[0] = p[1];
+				if (n > 1)
 				{
-					char32_t c;
-					str += detail::utf_decode(str, &c);
-					buf += detail::utf_encode(c, buf);
+					p[1] = '.';
+					p += n + 1;
 				}
-				return buf - buffer;
+				else
+					p += 1;
+				int e = point - 1;
+				*p++ = 'e';
+				*p++ = e < 0 ? '-' : '+';
+				p += format_uint(p, (uint64_t)(e < 0 ? -e : e));
 			}
+			return p - buffer;
 		}
 
-		// set of functions that count code units in strings
-		template<typename T>
-		constexpr size_t count_chars() noexcept { return 0; }
-		template<typename T, typename U, typename... Args>
-		inline auto count_chars(const U *str, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t());
-		template<typename T, typename U, bool S, typename... Args>
-		inline auto count_chars(Slice<U, S> slice, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t());
-#if !defined(NO_STL)
-		template<typename T, class _Ty, class _Alloc, typename... Args>
-		inline auto count_chars(const std::vector<_Ty, _Alloc> &vec, const Args&... args) noexcept -> decltype(typename IsSomeChar<_Ty>::type(), size_t());
-		template<typename T, class _Elem, class _Traits, class _Alloc, typename... Args>
-		inline size_t count_chars(const std::basic_string<_Elem, _Traits, _Alloc> &str, const Args&... args) noexcept;
-#endif
-		template<typename T, typename U, typename... Args>
-		inline auto count_chars(U item, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+		// writes the shortest string which parses back to the same value
+		template <typename T, typename F>
+		inline size_t format_float(T *buffer, F value) noexcept
 		{
-			return count_chars<T>(args...) + utf_seq_length<T>(item);
+			using Bits = typename FloatFormat<F>::Bits;
+			enum { SignificandBits = FloatFormat<F>::SignificandBits, ExponentBits = FloatFormat<F>::ExponentBits };
+			const Bits expMask = (Bits)((1 << ExponentBits) - 1) << SignificandBits;
+
+			Bits bits;
+			memcpy(&bits, &value, sizeof(bits));
+			T *p = buffer;
+			if ((bits & expMask) == expMask)
+			{
+				if (bits & (((Bits)1 << SignificandBits) - 1))
+					return format_ascii(p, "nan");
+				if (bits >> (SignificandBits + ExponentBits))
+					*p++ = '-';
+				return p - buffer + format_ascii(p, "inf");
+			}
+			if (bits >> (SignificandBits + ExponentBits))
+				*p++ = '-';
+			bits &= ~((Bits)1 << (SignificandBits + ExponentBits));
+			if (!bits)
+			{
+				*p++ = '0';
+				return p - buffer;
+			}
+			DecimalFloat d = shortest_decimal<F>(bits);
+			return p - buffer + format_decimal(p, d.digits, d.exponent);
 		}
-		template<typename T, typename U, bool S, typename... Args>
-		inline auto count_chars(Slice<U, S> slice, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+
+		template <typename T, typename U>
+		inline size_t format_number(T *buffer, U value, std::true_type) noexcept
 		{
-			return count_chars<T>(args...) + num_code_units<T>(slice.ptr, slice.length);
+			using F = typename std::conditional<sizeof(U) == sizeof(float), float, double>::type;
+			return format_float(buffer, (F)value);
 		}
-		template<typename T, typename U, typename... Args>
-		inline auto count_chars(const U *str, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+		template <typename T, typename U>
+		inline size_t format_number(T *buffer, U value, std::false_type) noexcept
 		{
-			return count_chars<T>(args...) + num_code_units<T>(str);
+			if (std::is_signed<U>::value && (int64_t)value < 0)
+			{
+				*buffer = '-';
+				return 1 + format_uint(buffer + 1, 0 - (uint64_t)value);
+			}
+			return format_uint(buffer, (uint64_t)value);
 		}
-#if !defined(NO_STL)
-		template<typename T, class _Ty, class _Alloc, typename... Args>
-		inline auto count_chars(const std::vector<_Ty, _Alloc> &vec, const Args&... args) noexcept -> decltype(typename IsSomeChar<_Ty>::type(), size_t())
+		template <typename U>
+		inline size_t max_number_chars(U, std::true_type) noexcept
 		{
-			return count_chars<T>(Slice<const _Ty>(vec.data(), vec.size()), args...);
+			return FloatFormat<typename std::conditional<sizeof(U) == sizeof(float), float, double>::type>::MaxChars;
 		}
-		template<typename T, class _Elem, class _Traits, class _Alloc, typename... Args>
-		inline size_t count_chars(const std::basic_string<_Elem, _Traits, _Alloc> &str, const Args&... args) noexcept
+		template <typename U>
+		inline size_t max_number_chars(U value, std::false_type) noexcept
 		{
-			static_assert(IsSomeChar<_Elem>::value, "std::basic_string does not have character element!");
-			return count_chars<T>(Slice<const _Elem>(str.data(), str.length()), args...);
+			if (std::is_signed<U>::value && (int64_t)value < 0)
+				return 1 + count_digits(0 - (uint64_t)value);
+			return count_digits((uint64_t)value);
 		}
-#endif
 
-		// set of functions that append strings
-		template<typename T>
-		inline T* append_string(T *buffer) noexcept { return buffer; }
-		template<typename T, typename U, typename... Args>
-		inline auto append_string(T *buffer, const U *s, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), return_t_star<T>());
-		template<typename T, typename U, bool S, typename... Args>
-		inline auto append_string(T *buffer, Slice<U, S> s, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), return_t_star<T>());
+		// set of functions that estimate the code units an item will append, without decoding it; the estimate is exact
+		// for characters, and for strings of the same width or which are ascii, and numbers estimate the most they may write
+		template<typename T, typename U>
+		inline auto estimate_code_units(U c) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+		{
+			return utf_seq_length<T>(c);
+		}
+		template<typename T, typename U>
+		inline auto estimate_code_units(U value) noexcept -> decltype(typename IsSomeNumber<U>::type(), size_t())
+		{
+			return max_number_chars(value, std::is_floating_point<U>());
+		}
+		template<typename T, typename U, bool S>
+		inline auto estimate_code_units(Slice<U, S> s) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+		{
+			return s.length;
+		}
+		template<typename T, typename U>
+		inline auto estimate_code_units(const U *s) noexcept -> decltype(typename IsSomeChar<U>::type(), size_t())
+		{
+			return detail::strlen(s);
+		}
 #if !defined(NO_STL)
-		template<typename T, class _Ty, class _Alloc, typename... Args>
-		inline auto append_string(T *buffer, const std::vector<_Ty, _Alloc> &vec, const Args&... args) noexcept -> decltype(typename IsSomeChar<_Ty>::type(), return_t_star<T>());
-		template<typename T, class _Elem, class _Traits, class _Alloc, typename... Args>
-		inline T* append_string(T *buffer, const std::basic_string<_Elem, _Traits, _Alloc> &str, const Args&... args) noexcept;
-#endif
-		template<typename T, typename U, typename... Args>
-		inline auto append_string(T *buffer, U c, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), return_t_star<T>())
+		template<typename T, class _Ty, class _Alloc>
+		inline auto estimate_code_units(const std::vector<_Ty, _Alloc> &vec) noexcept -> decltype(typename IsSomeChar<_Ty>::type(), size_t())
 		{
-			size_t len = utf_encode(c, buffer);
-			append_string(buffer + len, args...);
-			return buffer;
+			return vec.size();
 		}
-		template<typename T, typename U, bool S, typename... Args>
-		inline auto append_string(T *buffer, Slice<U, S> s, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), return_t_star<T>())
+		template<typename T, class _Elem, class _Traits, class _Alloc>
+		inline size_t estimate_code_units(const std::basic_string<_Elem, _Traits, _Alloc> &str) noexcept
 		{
-			size_t len = transcode_string(buffer, s.ptr, s.length);
-			append_string(buffer + len, args...);
-			return buffer;
+			return str.length();
 		}
-		template<typename T, typename U, typename... Args>
-		inline auto append_string(T *buffer, const U *s, const Args&... args) noexcept -> decltype(typename IsSomeChar<U>::type(), return_t_star<T>())
+#endif
+
+		enum : size_t { FormatText = (size_t)-1 };
+
+		struct FormatOp
 		{
-			T *buf = buffer;
-			if (sizeof(U) == sizeof(T))
+			size_t offset = 0, length = 0;	// the text, when arg is FormatText
+			size_t arg = 0;
+		};
+
+		// parses the op at pos, which is advanced past it
+		template <typename U>
+		constexpr FormatOp next_format_op(const U *format, size_t len, size_t &pos, size_t &nextArg, bool &error) noexcept
+		{
+			size_t start = pos;
+			while (pos < len && format[pos] != '{' && format[pos] != '}')
+				++pos;
+			if (pos > start)
+				return { start, pos - start, FormatText };
+			if (pos + 1 < len && format[pos + 1] == format[pos])
 			{
-				while (*s)
-					*buf++ = (T)*s++; // hack: cast because we no 'if constexpr' :(
+				pos += 2;
+				return { start, 1, FormatText };
 			}
-			else
+			size_t arg = 0;
+			if (format[pos++] == '{')
 			{
-				while (*s)
+				if (pos < len && format[pos] == '}')
+					arg = nextArg++;
+				else
 				{
-					char32_t c;
-					s += detail::utf_decode(s, &c);
-					buf += detail::utf_encode(c, buf);
+					while (pos < len && format[pos] >= '0' && format[pos] <= '9')
+						arg = arg*10 + (format[pos++] - '0');
+					if (pos == start + 1)
+						pos = len;
+				}
+				if (pos < len && format[pos] == '}')
+				{
+					++pos;
+					return { 0, 0, arg };
 				}
 			}
-
-			append_string(buf, args...);
-			return buffer;
-		}
-#if !defined(NO_STL)
-		template<typename T, class _Ty, class _Alloc, typename... Args>
-		inline auto append_string(T *buffer, const std::vector<_Ty, _Alloc> &vec, const Args&... args) noexcept -> decltype(typename IsSomeChar<_Ty>::type(), return_t_star<T>())
-		{
-			return append_string(buffer, Slice<const _Ty>(vec.data(), vec.size()), args...);
+			// unmatched brace
+			error = true;
+			pos = len;
+			return { start, 0, FormatText };
 		}
-		template<typename T, class _Elem, class _Traits, class _Alloc, typename... Args>
-		inline T* append_string(T *buffer, const std::basic_string<_Elem, _Traits, _Alloc> &str, const Args&... args) noexcept
+
+		template <size_t N>
+		struct FormatOps
 		{
-			static_assert(IsSomeChar<_Elem>::value, "std::basic_string does not have character element!");
-			return append_string(buffer, Slice<const _Elem>(str.data(), str.length()), args...);
-		}
-#endif
+			FormatOp ops[N];
+			size_t numOps, numArgs;
+			bool error;
+
+			template <typename U>
+			constexpr FormatOps(const U *format, size_t len) noexcept
+				: ops(), numOps(0), numArgs(0), error(false)
+			{
+				size_t pos = 0, nextArg = 0;
+				while (pos < len)
+				{
+					FormatOp op = next_format_op(format, len, pos, nextArg, error);
+					if (op.arg != FormatText && op.arg >= numArgs)
+						numArgs = op.arg + 1;
+					ops[numOps++] = op;
+				}
+			}
+		};
 
 		inline int vscprintf(const char *format, va_list args) noexcept
 		{
@@ -845,7 +2048,7 @@ namespace beautifulcode
 #if defined(_MSC_VER)
 			return vsnprintf_s(s, count, count, format, args);
 #else
-			return vsnprintf(s, count, format, args);
+			return ::vsnprintf(s, count, format, args);
 #endif
 		}
 		inline int vsnprintf(wchar_t *s, size_t count, const wchar_t *format, va_list args) noexcept
@@ -890,17 +2093,17 @@ namespace beautifulcode
 	{
 		static_assert(detail::IsSomeChar<U>::value, "Argument is not a string type!");
 
-		if (!length)
+		if (!ptr || !length)
 			return;
 
-		size_t numCodepoints = detail::num_code_units<C>(ptr, length);
+		size_t numCodeUnits = detail::num_code_units<C>(ptr, length);
 
-		this->reserve(numCodepoints + 1);
-		this->length = numCodepoints;
+		this->reserve(numCodeUnits + 1);
+		this->length = numCodeUnits;
 
 		auto buffer = (typename std::remove_const<C>::type*)this->ptr;
-		size_t len = detail::transcode_string(buffer, ptr, length);
-		assert(len == numCodepoints);
+		size_t len = detail::transcode_string(buffer, numCodeUnits, ptr, length);
+		SLICE_ASSERT(len == numCodeUnits);
 		buffer[len] = 0;
 	}
 
@@ -912,45 +2115,7 @@ namespace beautifulcode
 	template <typename C, size_t Count>
 	template <typename U>
 	inline Array<C, Count, true>::Array(const U *c_str) noexcept
-	{
-		static_assert(detail::IsSomeChar<U>::value, "Argument is not a string type!");
-
-		if (!c_str || *c_str == 0)
-			return;
-		if (sizeof(C) == sizeof(U))
-		{
-			size_t len = detail::strlen(c_str);
-			this->reserve(len + 1);
-			auto ptr = (typename std::remove_const<C>::type*)this->ptr;
-			memcpy(ptr, c_str, sizeof(C) * len);
-			ptr[len] = 0;
-			this->length = len;
-		}
-		else
-		{
-			size_t numCodepoints = 0;
-			const U *s = c_str;
-			while (*s)
-			{
-				char32_t c;
-				s += detail::utf_decode(s, &c);
-				numCodepoints += detail::utf_seq_length<C>(c);
-			}
-
-			this->reserve(numCodepoints + 1);
-			this->length = numCodepoints;
-
-			auto ptr = (typename std::remove_const<C>::type*)this->ptr;
-			while (*c_str)
-			{
-				char32_t c;
-				c_str += detail::utf_decode(c_str, &c);
-				ptr += detail::utf_encode(c, ptr);
-			}
-			assert(ptr == this->ptr + this->length);
-			*ptr = 0;
-		}
-	}
+		: Array<C, Count, true>(c_str, c_str ? detail::strlen(c_str) : 0) {}
 
 #if !defined(NO_STL)
 	template <typename C, size_t Count>
@@ -976,12 +2141,7 @@ namespace beautifulcode
 	template <typename... Items>
 	inline Array<C, Count, true>::Array(Concat_T, const Items&... items) noexcept
 	{
-		using mutable_value_type = typename std::remove_const<value_type>::type;
-		size_t length = detail::count_chars<value_type>(items...);
-		reserve(length + 1);
-		detail::append_string<mutable_value_type>((mutable_value_type*)this->ptr, items...);
-		((mutable_value_type*)this->ptr)[length] = 0;
-		this->length = length;
+		append_items(items...);
 	}
 
 	template <typename C, size_t Count>
@@ -994,6 +2154,13 @@ namespace beautifulcode
 		va_end(args);
 	}
 
+	template <typename C, size_t Count>
+	template <typename F, typename... Args>
+	inline Array<C, Count, true>::Array(Format_T, const F &format, const Args&... args) noexcept
+	{
+		do_format(format, args...);
+	}
+
 	template <typename C, size_t Count>
 	inline Array<C, Count, true>& Array<C, Count, true>::operator=(const Array<C, Count, true> &str) noexcept
 	{
@@ -1030,12 +2197,7 @@ namespace beautifulcode
 	template<typename... Items>
 	inline Array<C, Count, true>& Array<C, Count, true>::append(const Items&... items) noexcept
 	{
-		using mutable_value_type = typename std::remove_const<value_type>::type;
-		size_t len = this->length + detail::count_chars<value_type>(items...);
-		this->reserve(len + 1);
-		detail::append_string<mutable_value_type>((mutable_value_type*)this->ptr + this->length, items...);
-		((mutable_value_type*)this->ptr)[len] = 0;
-		this->length = len;
+		append_items(items...);
 		return *this;
 	}
 
@@ -1051,19 +2213,36 @@ namespace beautifulcode
 		return *this;
 	}
 
+	template<typename C, size_t Count>
+	template <typename F, typename... Args>
+	inline Array<C, Count, true>& Array<C, Count, true>::format(const F &format, const Args&... args) noexcept
+	{
+		this->length = 0;
+		do_format(format, args...);
+		return *this;
+	}
+
+	template<typename C, size_t Count>
+	template <typename F, typename... Args>
+	inline Array<C, Count, true>& Array<C, Count, true>::append_format(const F &format, const Args&... args) noexcept
+	{
+		do_format(format, args...);
+		return *this;
+	}
+
 	template<typename C, size_t Count>
 	inline Array<C, Count, true>& Array<C, Count, true>::to_upper_in_place() noexcept
 	{
-		for (size_t i = 0; i < this->length; ++i)
-			this->ptr[i] = detail::to_upper(this->ptr[i]);
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		detail::change_case<U, true>((U*)this->ptr, this->length);
 		return *this;
 	}
 
 	template<typename C, size_t Count>
 	inline Array<C, Count, true>& Array<C, Count, true>::to_lower_in_place() noexcept
 	{
-		for (size_t i = 0; i < this->length; ++i)
-			this->ptr[i] = detail::to_lower(this->ptr[i]);
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		detail::change_case<U, false>((U*)this->ptr, this->length);
 		return *this;
 	}
 
@@ -1086,6 +2265,149 @@ namespace beautifulcode
 		return *this;
 	}
 
+	template<typename C, size_t Count>
+	template <typename U, typename... Args>
+	inline void Array<C, Count, true>::do_format(const U *format, const Args&... args) noexcept
+	{
+		do_format(Slice<const U>(format, detail::strlen(format)), args...);
+	}
+
+	template<typename C, size_t Count>
+	template <typename U, bool S, typename... Args>
+	inline void Array<C, Count, true>::do_format(Slice<U, S> format, const Args&... args) noexcept
+	{
+		static_assert(detail::IsSomeChar<U>::value, "'format' is not a string type.");
+
+		// parse as we go; the ops are the same as for compiled formats
+		size_t pos = 0, nextArg = 0;
+		bool error = false;
+		while (pos < format.length)
+		{
+			detail::FormatOp op = detail::next_format_op(format.ptr, format.length, pos, nextArg, error);
+			SLICE_ASSERT(!error);
+			if (op.arg == detail::FormatText)
+				append_items(format.slice(op.offset, op.offset + op.length));
+			else
+				append_arg(op.arg, args...);
+		}
+		append_items();
+	}
+
+	template<typename C, size_t Count>
+	template <typename F, typename... Args>
+	inline auto Array<C, Count, true>::do_format(F, const Args&... args) noexcept -> decltype(F::format_string(), void())
+	{
+		using U = typename std::remove_const<typename std::remove_reference<decltype(F::format_string()[0])>::type>::type;
+		enum : size_t { N = sizeof(F::format_string()) / sizeof(U) };
+		static constexpr detail::FormatOps<N> ops(F::format_string(), N - 1);
+		static_assert(!ops.error, "Unmatched brace in format string");
+		static_assert(ops.numArgs <= sizeof...(Args), "Format string refers to more arguments than were given");
+
+		const U *format = F::format_string();
+		for (size_t i = 0; i < ops.numOps; ++i)
+		{
+			if (ops.ops[i].arg == detail::FormatText)
+				append_items(Slice<const U>(format + ops.ops[i].offset, ops.ops[i].length));
+			else
+				append_arg(ops.ops[i].arg, args...);
+		}
+		append_items();
+	}
+
+	template<typename C, size_t Count>
+	template <typename... Items>
+	inline void Array<C, Count, true>::append_items(const Items&... items) noexcept
+	{
+		using mutable_value_type = typename std::remove_const<value_type>::type;
+		// reserve for the estimate, and write each item in one pass; only strings of another width may exceed their
+		// estimate, and those grow the array as they go
+		size_t estimates[sizeof...(Items) + 1] = { 0 };
+		size_t following = 0, i = 0;
+		// summed in the expansion rather than a loop, so constant estimates fold at compile time
+		int sum[] = { 0, (following += estimates[++i] = detail::estimate_code_units<mutable_value_type>(items), 0)... };
+		this->reserve(this->length + following + 1);
+		i = 0;
+		int order[] = { 0, (append_item(items, following -= estimates[++i]), 0)... };
+		(void)estimates, (void)sum, (void)order, (void)i;
+		((mutable_value_type*)this->ptr)[this->length] = 0;
+	}
+
+	template<typename C, size_t Count>
+	template <typename U>
+	inline auto Array<C, Count, true>::append_item(U c, size_t) noexcept -> decltype(typename detail::IsSomeChar<U>::type(), void())
+	{
+		using mutable_value_type = typename std::remove_const<value_type>::type;
+		this->length += detail::utf_encode(c, (mutable_value_type*)this->ptr + this->length);
+	}
+
+	template<typename C, size_t Count>
+	template <typename U>
+	inline auto Array<C, Count, true>::append_item(U value, size_t) noexcept -> decltype(typename detail::IsSomeNumber<U>::type(), void())
+	{
+		using mutable_value_type = typename std::remove_const<value_type>::type;
+		this->length += detail::format_number((mutable_value_type*)this->ptr + this->length, value, std::is_floating_point<U>());
+	}
+
+	template<typename C, size_t Count>
+	template <typename U, bool S>
+	inline void Array<C, Count, true>::append_item(Slice<U, S> s, size_t following) noexcept
+	{
+		using mutable_value_type = typename std::remove_const<value_type>::type;
+		if (sizeof(U) == sizeof(C))
+		{
+			// the estimate was exact
+			memcpy((mutable_value_type*)this->ptr + this->length, s.ptr, s.length * sizeof(C));
+			this->length += s.length;
+			return;
+		}
+		// 'following' is the estimate for the items after this one, which must remain reserved
+		const typename std::remove_const<U>::type *str = s.ptr, *end = s.ptr + s.length;
+		while (true)
+		{
+			// write what fits, then measure only the rest
+			Slice<C> buffer = this->get_buffer();
+			mutable_value_type *out = detail::transcode_some((mutable_value_type*)this->ptr + this->length, (mutable_value_type*)buffer.ptr + buffer.length - 1 - following, str, end);
+			this->length = out - this->ptr;
+			if (str >= end)
+				return;
+			this->reserve(this->length + detail::num_code_units<mutable_value_type>(str, end - str) + following + 1);
+		}
+	}
+
+	template<typename C, size_t Count>
+	template <typename U>
+	inline void Array<C, Count, true>::append_item(const U *s, size_t following) noexcept
+	{
+		static_assert(detail::IsSomeChar<U>::value, "Argument is not a string type!");
+		append_item(Slice<const U>(s, detail::strlen(s)), following);
+	}
+
+#if !defined(NO_STL)
+	template<typename C, size_t Count>
+	template <class _Ty, class _Alloc>
+	inline void Array<C, Count, true>::append_item(const std::vector<_Ty, _Alloc> &vec, size_t following) noexcept
+	{
+		append_item(Slice<const _Ty>(vec.data(), vec.size()), following);
+	}
+
+	template<typename C, size_t Count>
+	template <class _Elem, class _Traits, class _Alloc>
+	inline void Array<C, Count, true>::append_item(const std::basic_string<_Elem, _Traits, _Alloc> &str, size_t following) noexcept
+	{
+		append_item(Slice<const _Elem>(str.data(), str.length()), following);
+	}
+#endif
+
+	template<typename C, size_t Count>
+	template <typename Item, typename... Args>
+	inline void Array<C, Count, true>::append_arg(size_t i, const Item &item, const Args&... args) noexcept
+	{
+		if (i == 0)
+			append_items(item);
+		else
+			append_arg(i - 1, args...);
+	}
+
 	template<typename C, size_t Count>
 	template <typename U>
 	inline void Array<C, Count, true>::do_sprintf(const U *format, va_list args) noexcept
@@ -0,0 +1,275 @@
+/*
+ * Authors: Manu Evans
+ * Email:   turkeyman@gmail.com
+ * License: BSD, go for broke!
+ *
+ * What is:
+ * MultiSearcher finds occurrences of any of a set of patterns in a string with a single pass over the text.
+ * The patterns are compiled to an Aho-Corasick automaton, stored as a flat transition table indexed by
+ * state and character class, so that scanning costs one table lookup per code unit regardless of the
+ * number of patterns.
+ * Like Searcher, MultiSearcher is built once and may then be used to search any number of strings.
+ */
+
+#pragma once
+
+#include <array.h>
+
+namespace beautifulcode
+{
+	template <typename C>
+	struct MultiSearcher
+	{
+		static_assert(detail::IsSomeChar<C>::value, "Template argument C is not a character type!");
+
+		using value_type = typename std::remove_const<C>::type;
+
+		MultiSearcher() noexcept;
+		MultiSearcher(Slice<const Slice<const value_type>> patterns);
+
+		size_t num_patterns() const noexcept { return patternLength.length; }
+		size_t num_states() const noexcept { return numStates; }
+
+		// calls onMatch(size_t pattern, size_t offset) for every occurrence of every pattern, ordered by the end
+		// of the match, and longest first where several patterns end at the same place
+		template <typename Callback>
+		size_t find_all(Slice<const value_type> text, Callback &&onMatch) const;
+		// returns the offset of the match which ends first, or text.length if there is none
+		size_t find_first(Slice<const value_type> text, size_t *pattern = nullptr) const noexcept;
+		size_t count(Slice<const value_type> text) const noexcept;
+
+	private:
+		enum : uint32_t
+		{
+			OutputFlag = 0x80000000,
+			NoPattern = 0xFFFFFFFF
+		};
+
+		uint32_t numClasses;
+		uint32_t numStates;
+		uint32_t byteClass[256];		// class for each code unit < 256; class 0 is every code unit not found in a pattern
+		Array<uint32_t> wideUnits;		// sorted code units >= 256 which appear in patterns
+		Array<uint32_t> wideClasses;
+		Array<uint32_t> delta;			// [row + class] -> row of the next state; rows are state*numClasses, | OutputFlag when the state has matches
+		Array<uint32_t> firstPattern;	// per state; patterns which end at that state
+		Array<uint32_t> dictLink;		// per state; next state along the failure links which has patterns
+		Array<uint32_t> nextPattern;	// per pattern; next pattern with identical text
+		Array<uint32_t> patternLength;
+
+		uint32_t class_of(value_type c) const noexcept;
+		template <typename Callback>
+		size_t report(uint32_t state, size_t end, Callback &onMatch) const;
+	};
+
+
+	// -------------------------------------------------------------------------------------------------
+	// Implementation follows:
+	//
+
+	namespace detail
+	{
+		inline int compare_uint32(const void *a, const void *b) noexcept
+		{
+			uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+			return x < y ? -1 : (x > y ? 1 : 0);
+		}
+	}
+
+	template <typename C>
+	inline MultiSearcher<C>::MultiSearcher() noexcept
+		: numClasses(1), numStates(0)
+	{
+		memset(byteClass, 0, sizeof(byteClass));
+	}
+
+	template <typename C>
+	inline MultiSearcher<C>::MultiSearcher(Slice<const Slice<const value_type>> patterns)
+		: MultiSearcher()
+	{
+		using unit_type = typename detail::SizedUint<sizeof(value_type)>::type;
+
+		// assign a character class to each distinct code unit that appears in a pattern
+		for (auto &p : patterns)
+		{
+			for (value_type c : p)
+			{
+				unit_type u = (unit_type)c;
+				if (u < 256)
+				{
+					if (!byteClass[u])
+						byteClass[u] = numClasses++;
+				}
+				else
+					wideUnits.push_back((uint32_t)u);
+			}
+		}
+		if (wideUnits.length)
+		{
+			qsort(wideUnits.ptr, wideUnits.length, sizeof(uint32_t), detail::compare_uint32);
+			size_t unique = 0;
+			for (size_t i = 0; i < wideUnits.length; ++i)
+			{
+				if (unique == 0 || wideUnits[i] != wideUnits[unique - 1])
+				{
+					wideUnits[unique++] = wideUnits[i];
+					wideClasses.push_back(numClasses++);
+				}
+			}
+			wideUnits.resize(unique);
+		}
+
+		// build the trie; transitions to state 0 are missing edges until the failure links are resolved
+		delta.resize(numClasses);
+		firstPattern.push_back(NoPattern);
+		numStates = 1;
+		for (size_t i = 0; i < patterns.length; ++i)
+		{
+			Slice<const value_type> p = patterns[i];
+			patternLength.push_back((uint32_t)p.length);
+			nextPattern.push_back(NoPattern);
+			if (p.empty())
+				continue;
+
+			uint32_t s = 0;
+			for (value_type c : p)
+			{
+				size_t edge = (size_t)s*numClasses + class_of(c);
+				if (!delta[edge])
+				{
+					delta[edge] = numStates++;
+					delta.resize(delta.length + numClasses);
+					firstPattern.push_back(NoPattern);
+				}
+				s = delta[edge];
+			}
+			if (firstPattern[s] == NoPattern)
+				firstPattern[s] = (uint32_t)i;
+			else
+			{
+				uint32_t dup = firstPattern[s];
+				while (nextPattern[dup] != NoPattern)
+					dup = nextPattern[dup];
+				nextPattern[dup] = (uint32_t)i;
+			}
+		}
+		SLICE_ASSERT((uint64_t)numStates*numClasses < OutputFlag);
+
+		// resolve failure links breadth-first, which completes the transition table into a DFA
+		Array<uint32_t> fail(Alloc, numStates);
+		Array<uint32_t> queue(Reserve, numStates);
+		dictLink.resize(numStates);
+		for (uint32_t c = 0; c < numClasses; ++c)
+		{
+			if (delta[c])
+				queue.push_back(delta[c]);
+		}
+		for (size_t head = 0; head < queue.length; ++head)
+		{
+			uint32_t s = queue[head];
+			uint32_t *row = delta.ptr + (size_t)s*numClasses;
+			const uint32_t *failRow = delta.ptr + (size_t)fail[s]*numClasses;
+			for (uint32_t c = 0; c < numClasses; ++c)
+			{
+				if (row[c])
+				{
+					uint32_t t = row[c], f = failRow[c];
+					fail[t] = f;
+					dictLink[t] = firstPattern[f] != NoPattern ? f : dictLink[f];
+					queue.push_back(t);
+				}
+				else
+					row[c] = failRow[c];
+			}
+		}
+
+		// convert state indices to row offsets, and flag the states which produce matches
+		for (uint32_t &t : delta)
+			t = t*numClasses | (firstPattern[t] != NoPattern || dictLink[t] ? (uint32_t)OutputFlag : 0);
+	}
+
+	template <typename C>
+	inline uint32_t MultiSearcher<C>::class_of(value_type c) const noexcept
+	{
+		using unit_type = typename detail::SizedUint<sizeof(value_type)>::type;
+		unit_type u = (unit_type)c;
+		if (sizeof(value_type) == 1 || u < 256)
+			return byteClass[u & 0xFF];
+
+		size_t lo = 0, hi = wideUnits.length;
+		while (lo < hi)
+		{
+			size_t mid = (lo + hi) >> 1;
+			if (wideUnits.ptr[mid] < u)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo < wideUnits.length && wideUnits.ptr[lo] == u ? wideClasses.ptr[lo] : 0;
+	}
+
+	template <typename C>
+	template <typename Callback>
+	inline size_t MultiSearcher<C>::report(uint32_t state, size_t end, Callback &onMatch) const
+	{
+		size_t numMatches = 0;
+		for (uint32_t s = state; s; s = dictLink.ptr[s])
+		{
+			for (uint32_t p = firstPattern.ptr[s]; p != NoPattern; p = nextPattern.ptr[p])
+			{
+				onMatch((size_t)p, end - patternLength.ptr[p]);
+				++numMatches;
+			}
+		}
+		return numMatches;
+	}
+
+	template <typename C>
+	template <typename Callback>
+	inline size_t MultiSearcher<C>::find_all(Slice<const value_type> text, Callback &&onMatch) const
+	{
+		if (numStates <= 1)
+			return 0;
+		const uint32_t *table = delta.ptr;
+		size_t numMatches = 0;
+		uint32_t row = 0;
+		for (size_t i = 0; i < text.length; ++i)
+		{
+			row = table[row + class_of(text.ptr[i])];
+			if (row & OutputFlag)
+			{
+				row &= ~(uint32_t)OutputFlag;
+				numMatches += report(row / numClasses, i + 1, onMatch);
+			}
+		}
+		return numMatches;
+	}
+
+	template <typename C>
+	inline size_t MultiSearcher<C>::find_first(Slice<const value_type> text, size_t *pattern) const noexcept
+	{
+		if (numStates <= 1)
+			return text.length;
+		const uint32_t *table = delta.ptr;
+		uint32_t row = 0;
+		for (size_t i = 0; i < text.length; ++i)
+		{
+			row = table[row + class_of(text.ptr[i])];
+			if (row & OutputFlag)
+			{
+				uint32_t s = (row & ~(uint32_t)OutputFlag) / numClasses;
+				if (firstPattern.ptr[s] == NoPattern)
+					s = dictLink.ptr[s];
+				if (pattern)
+					*pattern = firstPattern.ptr[s];
+				return i + 1 - patternLength.ptr[firstPattern.ptr[s]];
+			}
+		}
+		return text.length;
+	}
+
+	template <typename C>
+	inline size_t MultiSearcher<C>::count(Slice<const value_type> text) const noexcept
+	{
+		return find_all(text, [](size_t, size_t) {});
+	}
+}
@@ -17,8 +17,13 @@
 
 #include <array.h>
 
+#include <exception>
+
 namespace beautifulcode
 {
+	enum CacheHash_T { CacheHash };
+	enum WideRc_T { WideRc };
+
 	template <typename T, bool IsString = detail::IsSomeChar<T>::value>
 	struct SharedArray : public Slice<T>
 	{
@@ -46,19 +51,40 @@ namespace beautifulcode
 #endif
 		SharedArray(Alloc_T, size_t count);
 		template <typename... Items> SharedArray(Concat_T, Items&&... items);
+		// copies the elements to an allocation which caches their hash, so that hash() only hashes them once
+		template <typename U, bool S> SharedArray(CacheHash_T, Slice<U, S> slice);
+		// copies the elements to an allocation with a 64bit reference count, for arrays which may be referenced more
+		// times than the packed header counts; packed counts saturate and make the array immortal. Atomic counts
+		// saturate at ImmortalCount regardless
+		template <typename U, bool S> SharedArray(WideRc_T, Slice<U, S> slice);
+		template <typename U, bool S> SharedArray(detail::ArrayHeader::Flags flags, Slice<U, S> slice);
 		~SharedArray();
 
+		// incRef and decRef return the number of references after the change, which is approximate for arrays with
+		// biased counts that are shared between threads; the array is destroyed and this is cleared when decRef
+		// releases the last reference
 		size_t use_count() const;
 		size_t incRef();
 		size_t decRef();
 		bool unique() const { return use_count() == 1; }
 
+		// immortal arrays are never released, which makes copying static data cheap; call before sharing the array
+		// with other threads
+		void make_immortal() noexcept { if (this->ptr) detail::make_immortal(this->ptr); }
+
 		void alloc(size_t count);
 		void clear();
 
 		Array<T> claim();
 		template <size_t Count> Array<T, Count> clone() const { return Array<T, Count>(this->ptr, this->length); }
 
+		// the hash is cached for arrays constructed with CacheHash, when hashed with the default seed
+		uint64_t hash(uint64_t seed = detail::default_hash_seed()) const noexcept;
+
+		// compares the elements, but arrays whose hashes are cached and differ are unequal without comparing them
+		using Slice<T>::eq;
+		template <bool S> bool eq(const SharedArray<T, S> &arr) const noexcept;
+
 		bool operator==(SharedArray<T> arr) const;
 		bool operator!=(SharedArray<T> arr) const;
 
@@ -113,6 +139,12 @@ namespace beautifulcode
 		SharedArray(Alloc_T, size_t count) noexcept;
 		template <typename... Items> SharedArray(Concat_T, const Items&... items) noexcept;
 		template <typename U> SharedArray(Sprintf_T, const U *format, ...) noexcept;
+		template <typename F, typename... Args> SharedArray(Format_T, const F &format, const Args&... args) noexcept;
+		template <typename U, bool S> SharedArray(CacheHash_T, Slice<U, S> str) noexcept;
+		template <typename U> SharedArray(CacheHash_T, const U *c_str) noexcept;
+		template <typename U, bool S> SharedArray(WideRc_T, Slice<U, S> str) noexcept;
+		template <typename U> SharedArray(WideRc_T, const U *c_str) noexcept;
+		template <typename U, bool S> SharedArray(detail::ArrayHeader::Flags flags, Slice<U, S> str) noexcept;
 
 		SharedArray<C, true>& operator=(const SharedArray<C, true> &str) noexcept;
 		template <typename U, bool S> SharedArray<C, true>& operator=(SharedArray<U, S> &&rval) noexcept;
@@ -127,6 +159,13 @@ namespace beautifulcode
 	using SharedWString = SharedArray<const char16_t>;
 	using SharedDString = SharedArray<const char32_t>;
 
+	// shared arrays are just a reference to their allocation, so arrays of them may be grown in place
+	template <typename T, bool S>
+	struct TriviallyRelocatable<SharedArray<T, S>>
+	{
+		enum { value = true };
+	};
+
 	// -------------------------------------------------------------------------------------------------
 	// Implementation follows:
 	//
@@ -152,7 +191,7 @@ namespace beautifulcode
 		: Slice<T>(val.ptr, val.length)
 	{
 		if (this->ptr)
-			++detail::get_array_header(this->ptr)->rc;
+			detail::add_ref(this->ptr);
 	}
 	template <typename T, bool IsString>
 	template <typename U, bool S>
@@ -160,7 +199,7 @@ namespace beautifulcode
 		: Slice<T>(val.ptr, val.length)
 	{
 		if (this->ptr)
-			++detail::get_array_header(this->ptr)->rc;
+			detail::add_ref(this->ptr);
 	}
 
 	template <typename T, bool IsString>
@@ -185,6 +224,8 @@ namespace beautifulcode
 		}
 		else
 		{
+			if (rval.ptr)
+				detail::share_array(rval.ptr);
 			rval.ptr = nullptr;
 			rval.length = 0;
 		}
@@ -226,6 +267,28 @@ namespace beautifulcode
 	inline SharedArray<T, S>::SharedArray(Concat_T, Items&&... items)
 		: SharedArray<T, S>(Array<T, 0>(Concat, std::forward<Items>(items)...)) {}
 
+	template <typename T, bool IsString>
+	template <typename U, bool S>
+	inline SharedArray<T, IsString>::SharedArray(CacheHash_T, Slice<U, S> slice)
+		: SharedArray<T, IsString>(detail::ArrayHeader::CachedHash, slice) {}
+	template <typename T, bool IsString>
+	template <typename U, bool S>
+	inline SharedArray<T, IsString>::SharedArray(WideRc_T, Slice<U, S> slice)
+		: SharedArray<T, IsString>(detail::ArrayHeader::Wide, slice) {}
+	template <typename T, bool IsString>
+	template <typename U, bool S>
+	inline SharedArray<T, IsString>::SharedArray(detail::ArrayHeader::Flags flags, Slice<U, S> slice)
+	{
+		if (!slice.length)
+			return;
+		T *mem = detail::alloc_array<T>(sizeof(T)*slice.length, (detail::ArrayHeader::Flags)(flags | detail::array_flags<T>()));
+		for (size_t i = 0; i < slice.length; ++i)
+			new((void*)&mem[i]) T(slice.ptr[i]);
+		detail::share_array(mem);
+		this->ptr = mem;
+		this->length = slice.length;
+	}
+
 	template <typename T, bool S>
 	inline SharedArray<T, S>::~SharedArray()
 	{
@@ -242,7 +305,7 @@ namespace beautifulcode
 	inline size_t SharedArray<T, S>::use_count() const
 	{
 		if (this->ptr)
-			return detail::get_array_header(this->ptr)->rc;
+			return detail::ref_count(this->ptr);
 		else
 			return 0;
 	}
@@ -250,19 +313,22 @@ namespace beautifulcode
 	inline size_t SharedArray<T, S>::incRef()
 	{
 		if (this->ptr)
-			++detail::get_array_header(this->ptr)->rc;
+			return detail::add_ref(this->ptr);
+		return 0;
 	}
 	template <typename T, bool S>
 	inline size_t SharedArray<T, S>::decRef()
 	{
-		if (this->ptr)
+		if (!this->ptr)
+			return 0;
+		size_t rc = detail::release_ref(this->ptr, this->length);
+		if (!rc)
 		{
-			detail::ArrayHeader *header = detail::get_array_header(this->ptr);
-			if (header->rc == 1)
-				clear();
-			else
-				--header->rc;
+			detail::destroy_array<T>(this->ptr, this->length);
+			this->length = 0;
+			this->ptr = nullptr;
 		}
+		return rc;
 	}
 
 	template <typename T, bool S>
@@ -274,17 +340,7 @@ namespace beautifulcode
 	template <typename T, bool S>
 	inline void SharedArray<T, S>::clear()
 	{
-		if (!this->ptr)
-			return;
-		detail::ArrayHeader *header = detail::get_array_header(this->ptr);
-		if (header->rc > 1)
-			--header->rc;
-		else
-		{
-			for (size_t i = 0; i < this->length; ++i)
-				this->ptr[i].~T();
-			detail::free_array(this->ptr);
-		}
+		decRef();
 		this->length = 0;
 		this->ptr = nullptr;
 	}
@@ -297,6 +353,10 @@ namespace beautifulcode
 		Array<T> arr;
 		if (this->length > 0)
 		{
+			// the array may be modified once it's claimed
+			if (detail::ArrayHashCache *cache = detail::get_hash_cache(this->ptr))
+				cache->hash = 0;
+			detail::claim_array(this->ptr, sizeof(T)*this->length);
 			arr.ptr = this->ptr;
 			this->ptr = nullptr;
 			arr.length = this->length;
@@ -305,6 +365,40 @@ namespace beautifulcode
 		return arr;
 	}
 
+	template <typename T, bool S>
+	inline uint64_t SharedArray<T, S>::hash(uint64_t seed) const noexcept
+	{
+		detail::ArrayHashCache *cache = this->ptr ? detail::get_hash_cache(this->ptr) : nullptr;
+		if (!cache || seed != detail::default_hash_seed())
+			return Slice<T>::hash(seed);
+		// a hash of 0 is just never cached; sharers which race to fill the cache all store the same value
+		uint64_t hash = detail::load_cached_hash(this->ptr, cache);
+		if (!hash)
+		{
+			hash = Slice<T>::hash(seed);
+			detail::store_cached_hash(this->ptr, cache, hash);
+		}
+		return hash;
+	}
+
+	template <typename T, bool IsString>
+	template <bool S>
+	inline bool SharedArray<T, IsString>::eq(const SharedArray<T, S> &arr) const noexcept
+	{
+		if (this->length != arr.length)
+			return false;
+		if (this->ptr == arr.ptr || !this->length)
+			return true;
+		detail::ArrayHashCache *a = detail::get_hash_cache(this->ptr), *b = detail::get_hash_cache(arr.ptr);
+		if (a && b)
+		{
+			uint64_t ha = detail::load_cached_hash(this->ptr, a), hb = detail::load_cached_hash(arr.ptr, b);
+			if (ha && hb && ha != hb)
+				return false;
+		}
+		return Slice<T>::eq(arr);
+	}
+
 	template <typename T, bool S>
 	inline bool SharedArray<T, S>::operator==(SharedArray<T> arr) const
 	{
@@ -328,7 +422,7 @@ namespace beautifulcode
 			clear();
 			this->ptr = arr.ptr;
 			this->length = arr.length;
-			++detail::get_array_header(this->ptr)->rc;
+			detail::add_ref(this->ptr);
 		}
 		return *this;
 	}
@@ -356,7 +450,7 @@ namespace beautifulcode
 			clear();
 			this->ptr = arr.ptr;
 			this->length = arr.length;
-			++detail::get_array_header(this->ptr)->rc;
+			detail::add_ref(this->ptr);
 		}
 		return *this;
 	}
@@ -422,13 +516,14 @@ namespace beautifulcode
 		if (rval.is_allocated())
 		{
 			// claim allocation
+			detail::share_array(rval.ptr);
 			this->ptr = rval.ptr;
 			this->length = rval.length;
 			rval.ptr = nullptr;
 			rval.length = 0;
 		}
 		else if (rval.length)
-			new(this) Array<C, 0, true>(rval.ptr, rval.length);
+			new(this) SharedArray<C, true>(Array<C, 0, true>(rval.ptr, rval.length));
 	}
 
 	template <typename C>
@@ -479,6 +574,51 @@ namespace beautifulcode
 		va_end(args);
 	}
 
+	template <typename C>
+	template <typename F, typename... Args>
+	inline SharedArray<C, true>::SharedArray(Format_T, const F &format, const Args&... args) noexcept
+		: SharedArray<C, true>(Array<C, 0, true>(Format, format, args...)) {}
+
+	template <typename C>
+	template <typename U, bool S>
+	inline SharedArray<C, true>::SharedArray(CacheHash_T, Slice<U, S> str) noexcept
+		: SharedArray<C, true>(detail::ArrayHeader::CachedHash, str) {}
+
+	template <typename C>
+	template <typename U>
+	inline SharedArray<C, true>::SharedArray(CacheHash_T, const U *c_str) noexcept
+		: SharedArray<C, true>(detail::ArrayHeader::CachedHash, Slice<const U>(c_str, c_str ? detail::strlen(c_str) : 0)) {}
+
+	template <typename C>
+	template <typename U, bool S>
+	inline SharedArray<C, true>::SharedArray(WideRc_T, Slice<U, S> str) noexcept
+		: SharedArray<C, true>(detail::ArrayHeader::Wide, str) {}
+
+	template <typename C>
+	template <typename U>
+	inline SharedArray<C, true>::SharedArray(WideRc_T, const U *c_str) noexcept
+		: SharedArray<C, true>(detail::ArrayHeader::Wide, Slice<const U>(c_str, c_str ? detail::strlen(c_str) : 0)) {}
+
+	template <typename C>
+	template <typename U, bool S>
+	inline SharedArray<C, true>::SharedArray(detail::ArrayHeader::Flags flags, Slice<U, S> str) noexcept
+	{
+		static_assert(detail::IsSomeChar<U>::value, "Argument is not a string type!");
+
+		if (!str.length)
+			return;
+
+		size_t numCodeUnits = detail::num_code_units<C>(str.ptr, str.length);
+
+		auto buffer = detail::alloc_array<typename std::remove_const<C>::type>(sizeof(C)*(numCodeUnits + 1), (detail::ArrayHeader::Flags)(flags | detail::array_flags<C>()));
+		size_t len = detail::transcode_string(buffer, numCodeUnits, str.ptr, str.length);
+		SLICE_ASSERT(len == numCodeUnits);
+		buffer[len] = 0;
+		detail::share_array(buffer);
+		this->ptr = buffer;
+		this->length = len;
+	}
+
 	template <typename C>
 	inline SharedArray<C, true>& SharedArray<C, true>::operator=(const SharedArray<C, true> &str) noexcept
 	{
@@ -491,7 +631,7 @@ namespace beautifulcode
 			this->clear();
 			this->ptr = str.ptr;
 			this->length = str.length;
-			++detail::get_array_header(this->ptr)->rc;
+			detail::add_ref(this->ptr);
 		}
 		return *this;
 	}
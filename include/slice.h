@@ -12,10 +12,18 @@
 
 #pragma once
 
-#include <functional>
 #include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
 
 #if !defined(NO_STL)
+# include <functional>
+# include <stdexcept>
 # include <vector>
 # include <string>
 #endif
@@ -25,15 +33,62 @@
 # define SLICE_ASSERT(condition) assert(condition)
 #endif
 
+// SLICE_REALLOC lets arrays grow in place, and may be left undefined if the allocator doesn't support it
+#if !defined(SLICE_ALLOC) && !defined(SLICE_FREE) && !defined(SLICE_REALLOC)
+# define SLICE_REALLOC(ptr, bytes) realloc(ptr, bytes)
+#endif
 #if !defined(SLICE_ALLOC)
 # define SLICE_ALLOC(bytes) malloc(bytes)
 #endif
 #if !defined(SLICE_FREE)
 # define SLICE_FREE(ptr) free(ptr)
 #endif
+// arrays record the id of the module which allocated them, and are freed with that module's SLICE_FREE, so they may
+// be released by any module. Modules which don't share an allocator should #define a distinct id from 0 to 7
+#if !defined(SLICE_ALLOCATOR_ID)
+# define SLICE_ALLOCATOR_ID 0
+#endif
+
+// SIMD kernels are selected at compile time from the target ISA the compiler is building for.
+// Users may #define SLICE_NO_SIMD to force the scalar implementations.
+#if !defined(SLICE_NO_SIMD)
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SLICE_SIMD_SSE2
+# endif
+# if defined(__SSSE3__) || defined(__AVX__)
+#  define SLICE_SIMD_SSSE3
+# endif
+# if defined(__AVX2__)
+#  define SLICE_SIMD_AVX2
+# endif
+# if defined(__AVX512BW__)
+#  define SLICE_SIMD_AVX512
+# endif
+#endif
+#if defined(SLICE_SIMD_SSE2)
+# include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+#if defined(SLICE_RANDOM_HASH_SEED)
+# include <time.h>
+#endif
 
 namespace beautifulcode
 {
+	template <typename T> struct DelimiterSet;
+	template <typename T, typename Splitter> struct TokenRange;
+
+	// character classes for the string class scanning functions; classes are ASCII only
+	enum class CharClass
+	{
+		Whitespace,	// ' ', '\t', '\n', '\r'
+		Digit,		// '0'-'9'
+		Hex,		// '0'-'9', 'a'-'f', 'A'-'F'
+		Alnum		// '0'-'9', 'a'-'z', 'A'-'Z'
+	};
+
 	namespace detail
 	{
 		template <typename T> struct SliceElementType		{ using Ty = T; };
@@ -51,6 +106,31 @@ namespace beautifulcode
 		template <> struct IsSomeChar<const char32_t>		{ enum { value = true }; using type = int; };
 		template <> struct IsSomeChar<wchar_t>				{ enum { value = true }; using type = int; };
 		template <> struct IsSomeChar<const wchar_t>		{ enum { value = true }; using type = int; };
+
+		// numbers which may be appended to strings; bool and the character types are excluded
+		template <typename T, bool = std::is_arithmetic<T>::value && !IsSomeChar<T>::value && !std::is_same<T, bool>::value>
+		struct IsSomeNumber { enum { value = false }; };
+		template <typename T>
+		struct IsSomeNumber<T, true> { enum { value = true }; using type = int; };
+
+		template <typename T> struct IsSimdComparable;
+		template <size_t Size> struct SizedUint;
+		template <typename U, bool IgnoreCase> struct SubstrSearch;
+		template <typename T> struct IsDelimiterTable;
+		template <typename T, bool Simd = IsSimdComparable<T>::value> struct CompareElements;
+		template <typename U> struct DelimiterTable;
+
+		template <typename C>
+		const DelimiterSet<typename std::remove_const<C>::type>& whitespace_delimiters() noexcept;
+
+		template <typename T> struct TokenSplitter;
+		template <typename T> struct ElementSplitter;
+		template <typename T> struct SliceSplitter;
+		template <typename T> struct LineSplitter;
+
+		template <CharClass Class> struct CharClassTest;
+
+		inline uint64_t default_hash_seed() noexcept;
 	}
 
 	template <typename C>
@@ -138,7 +218,8 @@ namespace beautifulcode
 		constexpr bool operator!=(Slice<const T> slice) const noexcept { return ptr != slice.ptr || length != slice.length; }
 
 		bool eq(Slice<const T> slice) const noexcept;
-		ptrdiff_t cmp(Slice<const T> slice) const noexcept;
+		// if `mismatch` is given, it receives the index of the first element that differs, or the shorter length
+		ptrdiff_t cmp(Slice<const T> slice, size_t *mismatch = nullptr) const noexcept;
 
 		bool begins_with(Slice<const T> slice) const noexcept;
 		bool ends_with(Slice<const T> slice) const noexcept;
@@ -180,7 +261,11 @@ namespace beautifulcode
 		Slice<T> get_right_at_first(Slice<const T> s, bool inclusive = true) const noexcept;
 		Slice<T> get_right_at_last(Slice<const T> s, bool inclusive = true) const noexcept;
 
+#if !defined(NO_STL)
 		T *search(std::function<bool(const_reference e)> predFunc) const noexcept;
+#endif
+		template <typename Predicate>
+		auto search(Predicate &&pred) const noexcept -> decltype(bool(pred(std::declval<const_reference>())), (T*)nullptr);
 
 		ptrdiff_t index_of_element(const T *c) const noexcept;
 
@@ -191,11 +276,36 @@ namespace beautifulcode
 
 		template <bool SkipEmptyTokens = false>
 		Slice<T> pop_token(Slice<const T> delimiters) noexcept;
+		template <bool SkipEmptyTokens = false>
+		Slice<T> pop_token(const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) noexcept;
 
 		template <bool SkipEmptyTokens = false>
 		Slice<Slice<T>> tokenise(Slice<Slice<T>> tokens, Slice<const T> delimiters) noexcept;
+		template <bool SkipEmptyTokens = false>
+		Slice<Slice<T>> tokenise(Slice<Slice<T>> tokens, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) noexcept;
+#if !defined(NO_STL)
 		template <bool SkipEmptyTokens = false>
 		size_t tokenise(std::function<void(Slice<T> token, size_t index)> onToken, Slice<const T> delimiters) const noexcept;
+		template <bool SkipEmptyTokens = false>
+		size_t tokenise(std::function<void(Slice<T> token, size_t index)> onToken, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept;
+#endif
+		// calls onToken(Slice<T> token, size_t index) for each token; the callback is inlined
+		template <bool SkipEmptyTokens = false, typename Callback>
+		auto tokenise(Callback &&onToken, Slice<const T> delimiters) const noexcept -> decltype(onToken(Slice<T>(), size_t()), size_t());
+		template <bool SkipEmptyTokens = false, typename Callback>
+		auto tokenise(Callback &&onToken, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept -> decltype(onToken(Slice<T>(), size_t()), size_t());
+
+		// lazy ranges of tokens, for use with range-for; nothing is buffered or allocated.
+		// tokens() skips empty tokens, split() yields every token between separators, including empty ones
+		TokenRange<T, detail::TokenSplitter<T>> tokens(Slice<const T> delimiters) const noexcept;
+		TokenRange<T, detail::TokenSplitter<T>> tokens(const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept;
+		TokenRange<T, detail::ElementSplitter<T>> split(const_reference separator) const noexcept;
+		TokenRange<T, detail::SliceSplitter<T>> split(Slice<const T> separator) const noexcept;
+
+		// hashes the elements' bytes, for elements which are equal if and only if their bytes are (integers, enums,
+		// pointers and characters). the default seed is fixed, unless SLICE_RANDOM_HASH_SEED is defined, which selects
+		// a random seed once per process to resist hash flooding; hashes are then not stable between runs
+		uint64_t hash(uint64_t seed = detail::default_hash_seed()) const noexcept;
 	};
 
 	// specialisation for strings
@@ -226,7 +336,13 @@ namespace beautifulcode
 
 		CString<C> c_str() const noexcept { return CString<C>(this->ptr, this->length); }
 
+		// returns the offset of the first code unit which is not part of a well-formed utf sequence, or length if the
+		// string is valid. the other string functions trust their input, so untrusted data should be validated first
+		size_t validate_utf() const noexcept;
+
 		size_t num_chars() const noexcept;
+		// returns the offset of the first code unit of character `index`, or length if there are not that many
+		size_t char_offset(size_t index) const noexcept;
 		char32_t front_char() const noexcept;
 		char32_t back_char() const noexcept;
 		char32_t pop_front_char() noexcept;
@@ -259,19 +375,55 @@ namespace beautifulcode
 		template<bool Front = true, bool Back = true>
 		Slice<C> trim() const noexcept;
 
+		// find the first/last character which is, or is not, in a character class; returns length if there is none
+		template <CharClass Class> size_t find_first_of() const noexcept;
+		template <CharClass Class> size_t find_last_of() const noexcept;
+		template <CharClass Class> size_t find_first_not_of() const noexcept;
+		template <CharClass Class> size_t find_last_not_of() const noexcept;
+
+		// the default delimiters are whitespace; " \t\n\r"
 		template<bool SkipEmptyTokens = true>
-		Slice<C> pop_token(Slice<const C> delimiters = " \t\n\r") noexcept																	{ return ((Slice<C, false>*)this)->pop_token<SkipEmptyTokens>(delimiters); }
+		Slice<C> pop_token() noexcept																																	{ return ((Slice<C, false>*)this)->template pop_token<SkipEmptyTokens>(detail::whitespace_delimiters<C>()); }
 		template<bool SkipEmptyTokens = true>
-		Slice<Slice<C>> tokenise(Slice<Slice<C>> tokens, Slice<const C> delimiters = " \t\n\r") noexcept									{ return ((Slice<C, false>*)this)->tokenise<SkipEmptyTokens>(tokens, delimiters); }
+		Slice<C> pop_token(Slice<const C> delimiters) noexcept																											{ return ((Slice<C, false>*)this)->template pop_token<SkipEmptyTokens>(delimiters); }
 		template<bool SkipEmptyTokens = true>
-		size_t tokenise(std::function<void(Slice<C> token, size_t index)> onToken, Slice<const C> delimiters = " \t\n\r") const noexcept	{ return ((Slice<C, false>*)this)->tokenise<SkipEmptyTokens>(onToken, delimiters); }
-
-		int64_t parse_int(bool detectBase, int base = 10) const noexcept;
+		Slice<C> pop_token(const DelimiterSet<typename std::remove_const<C>::type> &delimiters) noexcept																{ return ((Slice<C, false>*)this)->template pop_token<SkipEmptyTokens>(delimiters); }
+		template<bool SkipEmptyTokens = true>
+		Slice<Slice<C>> tokenise(Slice<Slice<C>> tokens) noexcept																										{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(tokens, detail::whitespace_delimiters<C>()); }
+		template<bool SkipEmptyTokens = true>
+		Slice<Slice<C>> tokenise(Slice<Slice<C>> tokens, Slice<const C> delimiters) noexcept																			{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(tokens, delimiters); }
+		template<bool SkipEmptyTokens = true>
+		Slice<Slice<C>> tokenise(Slice<Slice<C>> tokens, const DelimiterSet<typename std::remove_const<C>::type> &delimiters) noexcept									{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(tokens, delimiters); }
+#if !defined(NO_STL)
+		template<bool SkipEmptyTokens = true>
+		size_t tokenise(std::function<void(Slice<C> token, size_t index)> onToken) const noexcept																		{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(onToken, detail::whitespace_delimiters<C>()); }
+		template<bool SkipEmptyTokens = true>
+		size_t tokenise(std::function<void(Slice<C> token, size_t index)> onToken, Slice<const C> delimiters) const noexcept											{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(onToken, delimiters); }
+		template<bool SkipEmptyTokens = true>
+		size_t tokenise(std::function<void(Slice<C> token, size_t index)> onToken, const DelimiterSet<typename std::remove_const<C>::type> &delimiters) const noexcept	{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(onToken, delimiters); }
+#endif
+		template<bool SkipEmptyTokens = true, typename Callback>
+		auto tokenise(Callback &&onToken) const noexcept -> decltype(onToken(Slice<C>(), size_t()), size_t())	{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(std::forward<Callback>(onToken), detail::whitespace_delimiters<C>()); }
+		template<bool SkipEmptyTokens = true, typename Callback>
+		auto tokenise(Callback &&onToken, Slice<const C> delimiters) const noexcept -> decltype(onToken(Slice<C>(), size_t()), size_t())	{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(std::forward<Callback>(onToken), delimiters); }
+		template<bool SkipEmptyTokens = true, typename Callback>
+		auto tokenise(Callback &&onToken, const DelimiterSet<typename std::remove_const<C>::type> &delimiters) const noexcept -> decltype(onToken(Slice<C>(), size_t()), size_t())	{ return ((Slice<C, false>*)this)->template tokenise<SkipEmptyTokens>(std::forward<Callback>(onToken), delimiters); }
+
+		TokenRange<C, detail::TokenSplitter<C>> tokens() const noexcept																		{ return ((Slice<C, false>*)this)->tokens(detail::whitespace_delimiters<C>()); }
+		TokenRange<C, detail::TokenSplitter<C>> tokens(Slice<const C> delimiters) const noexcept											{ return ((Slice<C, false>*)this)->tokens(delimiters); }
+		TokenRange<C, detail::TokenSplitter<C>> tokens(const DelimiterSet<typename std::remove_const<C>::type> &delimiters) const noexcept	{ return ((Slice<C, false>*)this)->tokens(delimiters); }
+		// lines are separated by '\n', with any trailing '\r' removed; a final empty line is not produced
+		TokenRange<C, detail::LineSplitter<C>> lines() const noexcept;
+
+		// parse an integer after any leading whitespace; decimal numbers may be signed, and other bases parse the
+		// bits of an unsigned 64bit number. `taken` receives the number of characters consumed, which is 0 if there
+		// is no number. `overflow` is set if the number is out of range, in which case the result is saturated.
+		int64_t parse_int(bool detectBase, int base = 10, size_t *taken = nullptr, bool *overflow = nullptr) const noexcept;
 		template <int base = 10>
-		int64_t parse_int() const noexcept { return parse_int(false, base); }
-		double parse_float() const noexcept;
-
-		uint32_t hash(uint32_t hash = 0x811C9DC5) const noexcept;
+		int64_t parse_int(size_t *taken = nullptr, bool *overflow = nullptr) const noexcept { return parse_int(false, base, taken, overflow); }
+		// parse a floating point number after any leading whitespace, correctly rounded; also accepts "inf",
+		// "infinity" and "nan". `taken` and `overflow` are as for parse_int; the result of an overflow is infinity.
+		double parse_float(size_t *taken = nullptr, bool *overflow = nullptr) const noexcept;
 	};
 
 	// define string types
@@ -279,6 +431,124 @@ namespace beautifulcode
 	using WString = Slice<const char16_t>;
 	using DString = Slice<const char32_t>;
 
+	// Searcher prepares a needle once, so that it may be found efficiently in any number of haystacks.
+	// The needle is not copied; it must outlive the Searcher.
+	template <typename T, bool CaseInsensitive = false>
+	struct Searcher
+	{
+		static_assert(!CaseInsensitive || detail::IsSomeChar<T>::value, "Case-insensitive search requires a character type!");
+
+		using value_type = typename std::remove_const<T>::type;
+
+		Searcher(Slice<const value_type> needle) noexcept;
+
+		Slice<const value_type> needle() const noexcept { return{ (const value_type*)impl.x, impl.m }; }
+
+		size_t find_first(Slice<const value_type> haystack) const noexcept;
+		size_t find_last(Slice<const value_type> haystack) const noexcept;
+
+		template <typename Callback>
+		size_t find_all(Slice<const value_type> haystack, Callback &&onMatch) const;
+		size_t count(Slice<const value_type> haystack) const noexcept;
+
+	private:
+		template <typename U, bool IgnoreCase, bool Simd = detail::IsSimdComparable<U>::value>
+		struct Impl
+		{
+			const U *x;
+			size_t m;
+			void init(const U *needle, size_t len, int) noexcept { x = needle; m = len; }
+			size_t find_first(const U *y, size_t n) const noexcept;
+			size_t find_last(const U *y, size_t n) const noexcept;
+		};
+		template <typename U, bool IgnoreCase>
+		struct Impl<U, IgnoreCase, true> : detail::SubstrSearch<typename detail::SizedUint<sizeof(U)>::type, IgnoreCase> {};
+
+		Impl<value_type, CaseInsensitive> impl;
+	};
+	template <typename C>
+	using Searcher_ic = Searcher<C, true>;
+
+	// DelimiterSet prepares a set of delimiters once, so that tokenising may classify elements without searching the set.
+	// Characters and small integers are classified with a 256-bit bitmap, and with SIMD where the set suits it; values
+	// above 255 are range checked before searching the set.
+	// The delimiters are not copied; they must outlive the DelimiterSet.
+	template <typename T>
+	struct DelimiterSet
+	{
+		using value_type = typename std::remove_const<T>::type;
+
+		DelimiterSet(Slice<const value_type> delimiters) noexcept;
+
+		Slice<const value_type> delimiters() const noexcept { return{ (const value_type*)impl.x, impl.k }; }
+
+		bool contains(const value_type &c) const noexcept;
+
+		// returns the index of the first element which is (or is not) a delimiter, or s.length if there is none
+		size_t find_first_of(Slice<const value_type> s) const noexcept;
+		size_t find_first_not_of(Slice<const value_type> s) const noexcept;
+
+	private:
+		template <typename U, bool Table = detail::IsDelimiterTable<U>::value>
+		struct Impl
+		{
+			const U *x;
+			size_t k;
+			void init(const U *delimiters, size_t len) noexcept { x = delimiters; k = len; }
+			bool contains(const U &c) const noexcept;
+			template <bool Members>
+			size_t find(const U *p, size_t n) const noexcept;
+		};
+		template <typename U>
+		struct Impl<U, true> : detail::DelimiterTable<typename detail::SizedUint<sizeof(U)>::type> {};
+
+		Impl<value_type> impl;
+	};
+
+	// TokenRange yields the tokens of a slice one at a time, as they are iterated.
+	// Iterators refer to the range, so the range must outlive them; range-for takes care of this.
+	template <typename T, typename Splitter>
+	struct TokenRange
+	{
+		struct iterator
+		{
+			using value_type = Slice<T>;
+			using reference = const Slice<T>&;
+			using pointer = const Slice<T>*;
+			using difference_type = ptrdiff_t;
+
+			reference operator*() const noexcept { return token; }
+			pointer operator->() const noexcept { return &token; }
+
+			iterator& operator++() noexcept;
+			iterator operator++(int) noexcept { iterator t = *this; ++*this; return t; }
+
+			bool operator==(const iterator &it) const noexcept { return done == it.done && (done || (token.ptr == it.token.ptr && token.length == it.token.length)); }
+			bool operator!=(const iterator &it) const noexcept { return !(*this == it); }
+
+		private:
+			friend struct TokenRange;
+
+			const Splitter *splitter;
+			Slice<T> token, rest;
+			bool more, done;
+		};
+		using const_iterator = iterator;
+
+		TokenRange(Slice<T> source, Splitter splitter) noexcept
+			: source(source), splitter(splitter) {}
+
+		iterator begin() const noexcept;
+		iterator end() const noexcept;
+
+		// true if there are no tokens
+		bool empty() const noexcept { return begin() == end(); }
+
+	private:
+		Slice<T> source;
+		Splitter splitter;
+	};
+
 	template <typename T, bool S>
 	constexpr bool operator==(nullptr_t, Slice<T, S> slice) noexcept { return slice == nullptr; }
 	template <typename T, bool S>
@@ -350,8 +620,12 @@ namespace beautifulcode
 	template <typename T, bool S>
 	constexpr typename Slice<T, S>::reference Slice<T, S>::at(size_t i) const
 	{
+#if !defined(NO_STL)
 		if (i >= length)
 			throw std::out_of_range("Index out of bounds");
+#else
+		SLICE_ASSERT(i < length);
+#endif
 		return ((value_type*)ptr)[i];
 	}
 
@@ -379,21 +653,18 @@ namespace beautifulcode
 	{
 		if (length != slice.length)
 			return false;
-		for (size_t i = 0; i < length; ++i)
-			if (((value_type*)ptr)[i] != ((value_type*)slice.ptr)[i])
-				return false;
-		return true;
+		return detail::CompareElements<value_type>::mismatch((const value_type*)ptr, (const value_type*)slice.ptr, length) == length;
 	}
 
 	template <typename T, bool S>
-	inline ptrdiff_t Slice<T, S>::cmp(Slice<const T> slice) const noexcept
+	inline ptrdiff_t Slice<T, S>::cmp(Slice<const T> slice, size_t *mismatch) const noexcept
 	{
 		size_t len = length < slice.length ? length : slice.length;
-		for (size_t i = 0; i < len; ++i)
-		{
-			if (((value_type*)ptr)[i] != ((value_type*)slice.ptr)[i])
-				return ((value_type*)ptr)[i] < ((value_type*)slice.ptr)[i] ? -1 : 1;
-		}
+		size_t i = detail::CompareElements<value_type>::mismatch((const value_type*)ptr, (const value_type*)slice.ptr, len);
+		if (mismatch)
+			*mismatch = i;
+		if (i < len)
+			return ((value_type*)ptr)[i] < ((value_type*)slice.ptr)[i] ? -1 : 1;
 		return length - slice.length;
 	}
 
@@ -463,414 +734,3052 @@ namespace beautifulcode
 
 	namespace detail
 	{
-		// hack to handle slices of slices
-		template <typename T> struct FindImpl								{ static inline bool eq(const T &a, const T &b) noexcept { return a == b; } };
-		template <typename U, bool S> struct FindImpl<Slice<U, S>>			{ static inline bool eq(const Slice<U, S> &a, const Slice<U, S> &b) noexcept { return a.eq(b); } };
-		template <typename U, bool S> struct FindImpl<const Slice<U, S>>	{ static inline bool eq(const Slice<U, S> &a, const Slice<U, S> &b) noexcept { return a.eq(b); } };
-	}
-	template <typename T, bool S>
-	inline size_t Slice<T, S>::find_first(const typename Slice<T, S>::value_type &c) const noexcept
-	{
-		size_t offset = 0;
-		while (offset < length && !detail::FindImpl<typename Slice<T, S>::value_type>::eq(ptr[offset], c))
-			++offset;
-		return offset;
-	}
-	template <typename T, bool S>
-	inline size_t Slice<T, S>::find_last(const typename Slice<T, S>::value_type &c) const noexcept
-	{
-		ptrdiff_t last = length - 1;
-		while (last >= 0 && !detail::FindImpl<typename Slice<T, S>::value_type>::eq(ptr[last], c))
-			--last;
-		return last < 0 ? length : last;
-	}
-	template <typename T, bool S>
-	inline size_t Slice<T, S>::find_first(Slice<const T> s) const noexcept
-	{
-		if (s.empty())
-			return 0;
-		ptrdiff_t len = length - s.length;
-		for (ptrdiff_t i = 0; i < len; ++i)
+		// types whose elements hash equal if and only if their bytes are equal may be hashed as bytes
+		template <typename T>
+		struct IsTriviallyHashable
 		{
-			size_t j = 0;
-			for (; j < s.length; ++j)
-			{
-				if (!detail::FindImpl<typename Slice<T, S>::value_type>::eq(ptr[i + j], s.ptr[j]))
-					break;
-			}
-			if (j == s.length)
-				return i;
+			using U = typename std::remove_cv<T>::type;
+			enum { value = std::is_integral<U>::value || std::is_enum<U>::value || std::is_pointer<U>::value };
+		};
+
+		// returns the low 64 bits of a * b in a, and the high 64 bits in b
+		inline void mul128(uint64_t &a, uint64_t &b) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 r = (unsigned __int128)a * b;
+			a = (uint64_t)r;
+			b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			a = _umul128(a, b, &b);
+#else
+			uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+			uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+			uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+			a = (mid << 32) | (uint32_t)ll;
+			b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+#endif
 		}
-		return length;
-	}
-	template <typename T, bool S>
-	inline size_t Slice<T, S>::find_last(Slice<const T> s) const noexcept
-	{
-		if (s.empty())
-			return length;
-		for (ptrdiff_t i = length - s.length; i >= 0; --i)
+		inline uint64_t hash_mix(uint64_t a, uint64_t b) noexcept
+		{
+			mul128(a, b);
+			return a ^ b;
+		}
+		inline uint64_t hash_read8(const unsigned char *p) noexcept { uint64_t v; memcpy(&v, p, 8); return v; }
+		inline uint64_t hash_read4(const unsigned char *p) noexcept { uint32_t v; memcpy(&v, p, 4); return v; }
+
+		// wyhash (Wang Yi, public domain); long inputs are mixed 48 bytes at a time in 3 independent lanes
+		inline uint64_t hash_bytes(const void *data, size_t len, uint64_t seed) noexcept
 		{
-			size_t j = 0;
-			for (; j < s.length; ++j)
+			static const uint64_t secret[4] = { 0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull, 0x4D5A2DA51DE1AA47ull };
+			const unsigned char *p = (const unsigned char*)data;
+			seed ^= hash_mix(seed ^ secret[0], secret[1]);
+			uint64_t a, b;
+			if (len <= 16)
 			{
-				if (!detail::FindImpl<typename Slice<T, S>::value_type>::eq(ptr[i + j], s.ptr[j]))
-					break;
+				if (len >= 4)
+				{
+					size_t mid = (len >> 3) << 2;
+					a = (hash_read4(p) << 32) | hash_read4(p + mid);
+					b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - mid);
+				}
+				else if (len > 0)
+				{
+					a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+					b = 0;
+				}
+				else
+					a = b = 0;
 			}
-			if (j == s.length)
-				return i;
+			else
+			{
+				size_t i = len;
+				if (i >= 48)
+				{
+					uint64_t seed1 = seed, seed2 = seed;
+					do
+					{
+						seed = hash_mix(hash_read8(p) ^ secret[1], hash_read8(p + 8) ^ seed);
+						seed1 = hash_mix(hash_read8(p + 16) ^ secret[2], hash_read8(p + 24) ^ seed1);
+						seed2 = hash_mix(hash_read8(p + 32) ^ secret[3], hash_read8(p + 40) ^ seed2);
+						p += 48;
+						i -= 48;
+					}
+					while (i >= 48);
+					seed ^= seed1 ^ seed2;
+				}
+				for (; i > 16; i -= 16, p += 16)
+					seed = hash_mix(hash_read8(p) ^ secret[1], hash_read8(p + 8) ^ seed);
+				a = hash_read8(p + i - 16);
+				b = hash_read8(p + i - 8);
+			}
+			a ^= secret[1];
+			b ^= seed;
+			mul128(a, b);
+			return hash_mix(a ^ secret[0] ^ len, b ^ secret[1]);
 		}
-		return length;
-	}
 
-	template <typename T, bool S>
-	inline T* Slice<T, S>::search(std::function<bool(const_reference e)> pred) const noexcept
-	{
-		for (size_t i = 0; i < length; ++i)
+		inline uint64_t default_hash_seed() noexcept
 		{
-			if (pred(ptr[i]))
-				return ptr + i;
+#if defined(SLICE_RANDOM_HASH_SEED)
+			// not cryptographic; the addresses vary with ASLR, and the time between runs
+			static const uint64_t seed = [] {
+				int local = 0;
+				uint64_t entropy[4] = { (uint64_t)(uintptr_t)&seed, (uint64_t)(uintptr_t)&local, (uint64_t)time(nullptr), (uint64_t)clock() };
+				return hash_bytes(entropy, sizeof(entropy), 0);
+			}();
+			return seed;
+#else
+			return 0;
+#endif
 		}
-		return nullptr;
-	}
-
-	template <typename T, bool S>
-	inline ptrdiff_t Slice<T, S>::index_of_element(const T *c) const noexcept
-	{
-		if (c >= ptr && c < ptr + length)
-			return c - ptr;
-		return -1;
-	}
-
-	template <typename T, bool S>
-	inline void Slice<T, S>::replace(const_reference oldval, const_reference newval) const
-	{
-		for (size_t i = 0; i < length; ++i)
-			if (ptr[i] == oldval)
-				ptr[i] = newval;
 	}
 
 	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_left_at_first(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
-	{
-		size_t offset = find_first(c);
-		if (offset != this->length)
-			offset += inclusive ? 1 : 0;
-		return{ this->ptr, offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_left_at_last(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
-	{
-		size_t offset = find_last(c);
-		if (offset != this->length)
-			offset += inclusive ? 1 : 0;
-		return{ this->ptr, offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_right_at_first(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
-	{
-		size_t offset = find_first(c);
-		if (offset != this->length)
-			offset += inclusive ? 0 : 1;
-		return{ this->ptr + offset, length - offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_right_at_last(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
+	inline uint64_t Slice<T, S>::hash(uint64_t seed) const noexcept
 	{
-		size_t offset = find_last(c);
-		if (offset != this->length)
-			offset += inclusive ? 0 : 1;
-		return{ this->ptr + offset, length - offset };
+		static_assert(detail::IsTriviallyHashable<value_type>::value, "Slice::hash() requires elements which are equal if and only if their bytes are equal");
+		return detail::hash_bytes(ptr, length * sizeof(value_type), seed);
 	}
 
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_left_at_first(Slice<const T> s, bool inclusive) const noexcept
-	{
-		size_t offset = find_first(s);
-		if (offset != this->length)
-			offset += inclusive ? s.length : 0;
-		return{ this->ptr, offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_left_at_last(Slice<const T> s, bool inclusive) const noexcept
-	{
-		size_t offset = find_last(s);
-		if (offset != this->length)
-			offset += inclusive ? s.length : 0;
-		return{ this->ptr, offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_right_at_first(Slice<const T> s, bool inclusive) const noexcept
-	{
-		size_t offset = find_first(s);
-		if (offset != this->length)
-			offset += inclusive ? 0 : s.length;
-		return{ this->ptr + offset, length - offset };
-	}
-	template <typename T, bool S>
-	inline Slice<T> Slice<T, S>::get_right_at_last(Slice<const T> s, bool inclusive) const noexcept
+	namespace detail
 	{
-		size_t offset = find_last(s);
-		if (offset != this->length)
-			offset += inclusive ? 0 : s.length;
-		return{ this->ptr + offset, length - offset };
-	}
+		// TODO: these are pretty lame! use lookup table? (requires .cpp file)
+		constexpr bool is_whitespace(char32_t c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+		constexpr bool is_hex(char32_t c) noexcept { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+		constexpr bool is_number(char32_t c) noexcept { return c >= '0' && c <= '9'; }
+		constexpr bool is_alnum(char32_t c) noexcept { return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'); }
 
-	template <typename T, bool S>
-	template <typename U>
-	inline size_t Slice<T, S>::copy_to(Slice<U> dest) const noexcept
-	{
-		SLICE_ASSERT(dest.length >= length);
-		for (size_t i = 0; i < length; ++i)
-			dest.ptr[i] = ptr[i];
-		return length;
-	}
+		constexpr char32_t to_lower(char32_t c) noexcept { return c >= 'A' && c <= 'Z' ? c | 0x20 : c; }
+		constexpr char32_t to_upper(char32_t c) noexcept { return c >= 'a' && c <= 'z' ? c & ~0x20 : c; }
 
-	template <typename T, bool S>
-	template <bool SkipEmptyTokens>
-	inline Slice<T> Slice<T, S>::pop_token(Slice<const T> delimiters) noexcept
-	{
-		size_t offset = 0;
-		if (SkipEmptyTokens)
+		inline unsigned ctz64(uint64_t bits) noexcept
 		{
-			while (offset < length && delimiters.contains(ptr[offset]))
-				++offset;
+			SLICE_ASSERT(bits != 0);
+#if defined(_MSC_VER)
+			unsigned long i;
+# if defined(_M_X64) || defined(_M_ARM64)
+			_BitScanForward64(&i, bits);
+# else
+			if ((uint32_t)bits)
+				_BitScanForward(&i, (uint32_t)bits);
+			else
+			{
+				_BitScanForward(&i, (uint32_t)(bits >> 32));
+				i += 32;
+			}
+# endif
+			return (unsigned)i;
+#else
+			return (unsigned)__builtin_ctzll(bits);
+#endif
 		}
-		size_t end = offset;
-		while (end < length && !delimiters.contains(ptr[end]))
-			++end;
-		Slice<T> token = slice(offset, end);
-		if (end < length)
-			++end;
-		ptr += end;
-		length -= end;
-		return token;
-	}
+		inline unsigned bsr64(uint64_t bits) noexcept
+		{
+			SLICE_ASSERT(bits != 0);
+#if defined(_MSC_VER)
+			unsigned long i;
+# if defined(_M_X64) || defined(_M_ARM64)
+			_BitScanReverse64(&i, bits);
+# else
+			if (bits >> 32)
+			{
+				_BitScanReverse(&i, (uint32_t)(bits >> 32));
+				i += 32;
+			}
+			else
+				_BitScanReverse(&i, (uint32_t)bits);
+# endif
+			return (unsigned)i;
+#else
+			return 63 - (unsigned)__builtin_clzll(bits);
+#endif
+		}
+		inline unsigned popcount64(uint64_t bits) noexcept
+		{
+#if defined(_MSC_VER) || !defined(__POPCNT__)
+			// __popcnt64 requires the popcnt instruction, which is not implied by SSE2, and without it the builtin is a
+			// library call
+			bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+			bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+			bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return (unsigned)((bits * 0x0101010101010101ull) >> 56);
+#else
+			return (unsigned)__builtin_popcountll(bits);
+#endif
+		}
+
+		// types which compare equal if and only if their bytes are equal may use the SIMD kernels
+		template <typename T>
+		struct IsSimdComparable
+		{
+			using U = typename std::remove_cv<T>::type;
+			enum { value = (std::is_integral<U>::value || std::is_enum<U>::value || std::is_pointer<U>::value) &&
+							(sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8) };
+		};
+
+		// Each SIMD register type exposes the same set of operations, so kernels may be written once as templates.
+		// `cmpeq` produces a comparison result `M`, and `mask` converts that result to a bitmask with
+		// `bits(Size)` bits per element, which is 1 bit per byte for SSE/AVX, and 1 bit per element for AVX-512.
+		// `in_range` selects elements in the range [first, first + count), and `flip_case` toggles the case bit (0x20)
+		// of elements in the range [first, first + 26), which converts the ASCII letters of one case to the other.
+		// `sign_bits` gathers the top bit of each byte, and `prev<N>` shifts the bytes of a vector up by N, shifting in
+		// the top N bytes of the vector before it.
+#if defined(SLICE_SIMD_SSE2)
+		struct Simd128
+		{
+			using V = __m128i;
+			using M = __m128i;
+			enum { Width = 16 };
+#if defined(SLICE_SIMD_SSSE3)
+			enum { HasShuffle = true };
+#else
+			enum { HasShuffle = false };
+#endif
+
+			static constexpr size_t bits(size_t size) noexcept { return size; }
+
+			static inline V load(const void *p) noexcept { return _mm_loadu_si128((const __m128i*)p); }
+			static inline void store(void *p, V v) noexcept { _mm_storeu_si128((__m128i*)p, v); }
+			static inline V broadcast16(const void *p) noexcept { return _mm_loadu_si128((const __m128i*)p); }
+			static inline V zero() noexcept { return _mm_setzero_si128(); }
+			template <size_t Size> static inline V splat(uint64_t v) noexcept;
+			template <size_t Size> static inline M cmpeq(V a, V b) noexcept;
+			template <size_t Size> static inline M in_range(V v, uint64_t first, uint64_t count) noexcept { static_assert(Size == 1 || Size == 2 || Size == 4, "in_range supports 1, 2 and 4 byte elements"); return cmpeq<Size>(v, v); }
+			template <size_t Size> static inline V flip_case(V v, uint64_t first) noexcept { return _mm_xor_si128(v, _mm_and_si128(in_range<Size>(v, first, 26), splat<Size>(0x20))); }
+			static inline M mor(M a, M b) noexcept { return _mm_or_si128(a, b); }
+			static inline M mand(M a, M b) noexcept { return _mm_and_si128(a, b); }
+			template <size_t Size> static inline uint64_t mask(M m) noexcept { return (uint32_t)_mm_movemask_epi8(m); }
+
+			static inline V vand(V a, V b) noexcept { return _mm_and_si128(a, b); }
+			static inline V vor(V a, V b) noexcept { return _mm_or_si128(a, b); }
+			static inline V vxor(V a, V b) noexcept { return _mm_xor_si128(a, b); }
+			static inline V srli4(V v) noexcept { return _mm_srli_epi16(v, 4); }
+			static inline V subs_u8(V a, V b) noexcept { return _mm_subs_epu8(a, b); }
+			static inline uint64_t sign_bits(V v) noexcept { return (uint32_t)_mm_movemask_epi8(v); }
+#if defined(SLICE_SIMD_SSSE3)
+			static inline V shuffle(V table, V index) noexcept { return _mm_shuffle_epi8(table, index); }
+			template <int N> static inline V prev(V v, V last) noexcept { return _mm_alignr_epi8(v, last, 16 - N); }
+#endif
+		};
+		template <> inline __m128i Simd128::splat<1>(uint64_t v) noexcept { return _mm_set1_epi8((char)v); }
+		template <> inline __m128i Simd128::splat<2>(uint64_t v) noexcept { return _mm_set1_epi16((short)v); }
+		template <> inline __m128i Simd128::splat<4>(uint64_t v) noexcept { return _mm_set1_epi32((int)v); }
+		template <> inline __m128i Simd128::splat<8>(uint64_t v) noexcept { return _mm_set1_epi64x((long long)v); }
+		template <> inline __m128i Simd128::cmpeq<1>(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi8(a, b); }
+		template <> inline __m128i Simd128::cmpeq<2>(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi16(a, b); }
+		template <> inline __m128i Simd128::cmpeq<4>(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi32(a, b); }
+		template <> inline __m128i Simd128::cmpeq<8>(__m128i a, __m128i b) noexcept
+		{
+			// SSE2 has no 64bit compare; both 32bit halves must match
+			__m128i r = _mm_cmpeq_epi32(a, b);
+			return _mm_and_si128(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+		// elements are biased so that the range lands at the bottom of the signed range, where one compare selects it
+		template <> inline __m128i Simd128::in_range<1>(__m128i v, uint64_t first, uint64_t count) noexcept { return _mm_cmpgt_epi8(_mm_set1_epi8((char)(0x80 + count)), _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - first)))); }
+		template <> inline __m128i Simd128::in_range<2>(__m128i v, uint64_t first, uint64_t count) noexcept { return _mm_cmpgt_epi16(_mm_set1_epi16((short)(0x8000 + count)), _mm_add_epi16(v, _mm_set1_epi16((short)(0x8000 - first)))); }
+		template <> inline __m128i Simd128::in_range<4>(__m128i v, uint64_t first, uint64_t count) noexcept { return _mm_cmpgt_epi32(_mm_set1_epi32((int)(0x80000000u + count)), _mm_add_epi32(v, _mm_set1_epi32((int)(0x80000000u - first)))); }
+#endif
+#if defined(SLICE_SIMD_AVX2)
+		struct Simd256
+		{
+			using V = __m256i;
+			using M = __m256i;
+			enum { Width = 32 };
+			enum { HasShuffle = true };
+
+			static constexpr size_t bits(size_t size) noexcept { return size; }
+
+			static inline V load(const void *p) noexcept { return _mm256_loadu_si256((const __m256i*)p); }
+			static inline void store(void *p, V v) noexcept { _mm256_storeu_si256((__m256i*)p, v); }
+			static inline V broadcast16(const void *p) noexcept { return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)p)); }
+			static inline V zero() noexcept { return _mm256_setzero_si256(); }
+			template <size_t Size> static inline V splat(uint64_t v) noexcept;
+			template <size_t Size> static inline M cmpeq(V a, V b) noexcept;
+			template <size_t Size> static inline M in_range(V v, uint64_t first, uint64_t count) noexcept { static_assert(Size == 1 || Size == 2 || Size == 4, "in_range supports 1, 2 and 4 byte elements"); return cmpeq<Size>(v, v); }
+			template <size_t Size> static inline V flip_case(V v, uint64_t first) noexcept { return _mm256_xor_si256(v, _mm256_and_si256(in_range<Size>(v, first, 26), splat<Size>(0x20))); }
+			static inline M mor(M a, M b) noexcept { return _mm256_or_si256(a, b); }
+			static inline M mand(M a, M b) noexcept { return _mm256_and_si256(a, b); }
+			template <size_t Size> static inline uint64_t mask(M m) noexcept { return (uint32_t)_mm256_movemask_epi8(m); }
+
+			static inline V vand(V a, V b) noexcept { return _mm256_and_si256(a, b); }
+			static inline V vor(V a, V b) noexcept { return _mm256_or_si256(a, b); }
+			static inline V vxor(V a, V b) noexcept { return _mm256_xor_si256(a, b); }
+			static inline V srli4(V v) noexcept { return _mm256_srli_epi16(v, 4); }
+			static inline V subs_u8(V a, V b) noexcept { return _mm256_subs_epu8(a, b); }
+			static inline uint64_t sign_bits(V v) noexcept { return (uint32_t)_mm256_movemask_epi8(v); }
+			static inline V shuffle(V table, V index) noexcept { return _mm256_shuffle_epi8(table, index); }
+			// shift the bytes of `v` up by N, shifting in the top bytes of `last`; palignr only works within 128bit lanes
+			template <int N> static inline V prev(V v, V last) noexcept { return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(last, v, 0x21), 16 - N); }
+		};
+		template <> inline __m256i Simd256::splat<1>(uint64_t v) noexcept { return _mm256_set1_epi8((char)v); }
+		template <> inline __m256i Simd256::splat<2>(uint64_t v) noexcept { return _mm256_set1_epi16((short)v); }
+		template <> inline __m256i Simd256::splat<4>(uint64_t v) noexcept { return _mm256_set1_epi32((int)v); }
+		template <> inline __m256i Simd256::splat<8>(uint64_t v) noexcept { return _mm256_set1_epi64x((long long)v); }
+		template <> inline __m256i Simd256::cmpeq<1>(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+		template <> inline __m256i Simd256::cmpeq<2>(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi16(a, b); }
+		template <> inline __m256i Simd256::cmpeq<4>(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi32(a, b); }
+		template <> inline __m256i Simd256::cmpeq<8>(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi64(a, b); }
+		template <> inline __m256i Simd256::in_range<1>(__m256i v, uint64_t first, uint64_t count) noexcept { return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + count)), _mm256_add_epi8(v, _mm256_set1_epi8((char)(0x80 - first)))); }
+		template <> inline __m256i Simd256::in_range<2>(__m256i v, uint64_t first, uint64_t count) noexcept { return _mm256_cmpgt_epi16(_mm256_set1_epi16((short)(0x8000 + count)), _mm256_add_epi16(v, _mm256_set1_epi16((short)(0x8000 - first)))); }
+		template <> inline __m256i Simd256::in_range<4>(__m256i v, uint64_t first, uint64_t count) noexcept { return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(0x80000000u + count)), _mm256_add_epi32(v, _mm256_set1_epi32((int)(0x80000000u - first)))); }
+#endif
+#if defined(SLICE_SIMD_AVX512)
+		struct Simd512
+		{
+			using V = __m512i;
+			using M = uint64_t;
+			enum { Width = 64 };
+			enum { HasShuffle = true };
+
+			static constexpr size_t bits(size_t) noexcept { return 1; }
+
+			static inline V load(const void *p) noexcept { return _mm512_loadu_si512(p); }
+			static inline void store(void *p, V v) noexcept { _mm512_storeu_si512(p, v); }
+			static inline V broadcast16(const void *p) noexcept { return _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)p)); }
+			static inline V zero() noexcept { return _mm512_setzero_si512(); }
+			template <size_t Size> static inline V splat(uint64_t v) noexcept;
+			template <size_t Size> static inline M cmpeq(V a, V b) noexcept;
+			template <size_t Size> static inline M in_range(V v, uint64_t first, uint64_t count) noexcept { static_assert(Size == 1 || Size == 2 || Size == 4, "in_range supports 1, 2 and 4 byte elements"); return cmpeq<Size>(v, v); }
+			template <size_t Size> static inline V flip_case(V v, uint64_t first) noexcept { static_assert(Size == 1 || Size == 2 || Size == 4, "flip_case supports 1, 2 and 4 byte elements"); return v; }
+			static inline M mor(M a, M b) noexcept { return a | b; }
+			static inline M mand(M a, M b) noexcept { return a & b; }
+			template <size_t Size> static inline uint64_t mask(M m) noexcept { return m; }
+
+			static inline V vand(V a, V b) noexcept { return _mm512_and_si512(a, b); }
+			static inline V vor(V a, V b) noexcept { return _mm512_or_si512(a, b); }
+			static inline V vxor(V a, V b) noexcept { return _mm512_xor_si512(a, b); }
+			static inline V srli4(V v) noexcept { return _mm512_srli_epi16(v, 4); }
+			static inline V subs_u8(V a, V b) noexcept { return _mm512_subs_epu8(a, b); }
+			static inline uint64_t sign_bits(V v) noexcept { return _mm512_movepi8_mask(v); }
+			static inline V shuffle(V table, V index) noexcept { return _mm512_shuffle_epi8(table, index); }
+			template <int N> static inline V prev(V v, V last) noexcept { return _mm512_alignr_epi8(v, _mm512_alignr_epi64(v, last, 6), 16 - N); }
+		};
+		template <> inline __m512i Simd512::splat<1>(uint64_t v) noexcept { return _mm512_set1_epi8((char)v); }
+		template <> inline __m512i Simd512::splat<2>(uint64_t v) noexcept { return _mm512_set1_epi16((short)v); }
+		template <> inline __m512i Simd512::splat<4>(uint64_t v) noexcept { return _mm512_set1_epi32((int)v); }
+		template <> inline __m512i Simd512::splat<8>(uint64_t v) noexcept { return _mm512_set1_epi64((long long)v); }
+		template <> inline uint64_t Simd512::cmpeq<1>(__m512i a, __m512i b) noexcept { return _mm512_cmpeq_epi8_mask(a, b); }
+		template <> inline uint64_t Simd512::cmpeq<2>(__m512i a, __m512i b) noexcept { return _mm512_cmpeq_epi16_mask(a, b); }
+		template <> inline uint64_t Simd512::cmpeq<4>(__m512i a, __m512i b) noexcept { return _mm512_cmpeq_epi32_mask(a, b); }
+		template <> inline uint64_t Simd512::cmpeq<8>(__m512i a, __m512i b) noexcept { return _mm512_cmpeq_epi64_mask(a, b); }
+		template <> inline uint64_t Simd512::in_range<1>(__m512i v, uint64_t first, uint64_t count) noexcept { return _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8((char)first)), _mm512_set1_epi8((char)count)); }
+		template <> inline uint64_t Simd512::in_range<2>(__m512i v, uint64_t first, uint64_t count) noexcept { return _mm512_cmplt_epu16_mask(_mm512_sub_epi16(v, _mm512_set1_epi16((short)first)), _mm512_set1_epi16((short)count)); }
+		template <> inline uint64_t Simd512::in_range<4>(__m512i v, uint64_t first, uint64_t count) noexcept { return _mm512_cmplt_epu32_mask(_mm512_sub_epi32(v, _mm512_set1_epi32((int)first)), _mm512_set1_epi32((int)count)); }
+		template <> inline __m512i Simd512::flip_case<1>(__m512i v, uint64_t first) noexcept { return _mm512_mask_blend_epi8(in_range<1>(v, first, 26), v, _mm512_xor_si512(v, _mm512_set1_epi8(0x20))); }
+		template <> inline __m512i Simd512::flip_case<2>(__m512i v, uint64_t first) noexcept { return _mm512_mask_blend_epi16((__mmask32)in_range<2>(v, first, 26), v, _mm512_xor_si512(v, _mm512_set1_epi16(0x20))); }
+		template <> inline __m512i Simd512::flip_case<4>(__m512i v, uint64_t first) noexcept { return _mm512_mask_xor_epi32(v, (__mmask16)in_range<4>(v, first, 26), v, _mm512_set1_epi32(0x20)); }
+#endif
+
+		// mask with the bits for every lane of a vector set
+		template <typename Vec, size_t Size>
+		constexpr uint64_t simd_lane_mask() noexcept
+		{
+			return Vec::Width / Size * Vec::bits(Size) == 64 ? ~0ull : (1ull << (Vec::Width / Size * Vec::bits(Size))) - 1;
+		}
+
+		// find the first/last element equal to `value`; `p` must hold at least one full vector of elements
+		template <typename Vec, size_t Size>
+		inline size_t simd_find_first_eq(const char *p, size_t n, uint64_t value) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const typename Vec::V needle = Vec::template splat<Size>(value);
+			size_t i = 0;
+			for (; i + Lanes*4 <= n; i += Lanes*4)
+			{
+				const char *b = p + i*Size;
+				typename Vec::M m0 = Vec::template cmpeq<Size>(Vec::load(b), needle);
+				typename Vec::M m1 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width), needle);
+				typename Vec::M m2 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width*2), needle);
+				typename Vec::M m3 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width*3), needle);
+				if (Vec::template mask<Size>(Vec::mor(Vec::mor(m0, m1), Vec::mor(m2, m3))))
+				{
+					uint64_t bits = Vec::template mask<Size>(m0);
+					if (bits)
+						return i + ctz64(bits) / Vec::bits(Size);
+					if ((bits = Vec::template mask<Size>(m1)) != 0)
+						return i + Lanes + ctz64(bits) / Vec::bits(Size);
+					if ((bits = Vec::template mask<Size>(m2)) != 0)
+						return i + Lanes*2 + ctz64(bits) / Vec::bits(Size);
+					return i + Lanes*3 + ctz64(Vec::template mask<Size>(m3)) / Vec::bits(Size);
+				}
+			}
+			for (; i + Lanes <= n; i += Lanes)
+			{
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::load(p + i*Size), needle));
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+			}
+			if (i < n)
+			{
+				// the final vector overlaps elements we already know don't match
+				i = n - Lanes;
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::load(p + i*Size), needle));
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+			}
+			return n;
+		}
+		template <typename Vec, size_t Size>
+		inline size_t simd_find_last_eq(const char *p, size_t n, uint64_t value) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const typename Vec::V needle = Vec::template splat<Size>(value);
+			size_t i = n;
+			for (; i >= Lanes*4; i -= Lanes*4)
+			{
+				const char *b = p + (i - Lanes*4)*Size;
+				typename Vec::M m0 = Vec::template cmpeq<Size>(Vec::load(b), needle);
+				typename Vec::M m1 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width), needle);
+				typename Vec::M m2 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width*2), needle);
+				typename Vec::M m3 = Vec::template cmpeq<Size>(Vec::load(b + Vec::Width*3), needle);
+				if (Vec::template mask<Size>(Vec::mor(Vec::mor(m0, m1), Vec::mor(m2, m3))))
+				{
+					uint64_t bits = Vec::template mask<Size>(m3);
+					if (bits)
+						return i - Lanes + bsr64(bits) / Vec::bits(Size);
+					if ((bits = Vec::template mask<Size>(m2)) != 0)
+						return i - Lanes*2 + bsr64(bits) / Vec::bits(Size);
+					if ((bits = Vec::template mask<Size>(m1)) != 0)
+						return i - Lanes*3 + bsr64(bits) / Vec::bits(Size);
+					return i - Lanes*4 + bsr64(Vec::template mask<Size>(m0)) / Vec::bits(Size);
+				}
+			}
+			for (; i >= Lanes; i -= Lanes)
+			{
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::load(p + (i - Lanes)*Size), needle));
+				if (bits)
+					return i - Lanes + bsr64(bits) / Vec::bits(Size);
+			}
+			if (i > 0)
+			{
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::load(p), needle));
+				if (bits)
+					return bsr64(bits) / Vec::bits(Size);
+			}
+			return n;
+		}
+
+		// dispatch to the widest vector that fits the data, falling back to scalar for very short arrays
+		template <typename T>
+		inline size_t find_first_eq(const T *p, size_t n, T value) noexcept
+		{
+			uint64_t v = 0;
+			memcpy(&v, &value, sizeof(T));
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(T))
+				return simd_find_first_eq<Simd512, sizeof(T)>((const char*)p, n, v);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(T))
+				return simd_find_first_eq<Simd256, sizeof(T)>((const char*)p, n, v);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(T))
+				return simd_find_first_eq<Simd128, sizeof(T)>((const char*)p, n, v);
+#endif
+			size_t i = 0;
+			while (i < n && p[i] != value)
+				++i;
+			return i;
+		}
+		template <typename T>
+		inline size_t find_last_eq(const T *p, size_t n, T value) noexcept
+		{
+			uint64_t v = 0;
+			memcpy(&v, &value, sizeof(T));
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(T))
+				return simd_find_last_eq<Simd512, sizeof(T)>((const char*)p, n, v);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(T))
+				return simd_find_last_eq<Simd256, sizeof(T)>((const char*)p, n, v);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(T))
+				return simd_find_last_eq<Simd128, sizeof(T)>((const char*)p, n, v);
+#endif
+			size_t i = n;
+			while (i > 0 && p[i - 1] != value)
+				--i;
+			return i > 0 ? i - 1 : n;
+		}
+
+		// hack to handle slices of slices
+		template <typename T> struct FindImpl								{ static inline bool eq(const T &a, const T &b) noexcept { return a == b; } };
+		template <typename U, bool S> struct FindImpl<Slice<U, S>>			{ static inline bool eq(const Slice<U, S> &a, const Slice<U, S> &b) noexcept { return a.eq(b); } };
+		template <typename U, bool S> struct FindImpl<const Slice<U, S>>	{ static inline bool eq(const Slice<U, S> &a, const Slice<U, S> &b) noexcept { return a.eq(b); } };
+
+		template <typename T, bool Simd = IsSimdComparable<T>::value>
+		struct FindElement
+		{
+			static inline size_t find_first(const T *p, size_t n, const T &c) noexcept
+			{
+				size_t offset = 0;
+				while (offset < n && !FindImpl<T>::eq(p[offset], c))
+					++offset;
+				return offset;
+			}
+			static inline size_t find_last(const T *p, size_t n, const T &c) noexcept
+			{
+				ptrdiff_t last = n - 1;
+				while (last >= 0 && !FindImpl<T>::eq(p[last], c))
+					--last;
+				return last < 0 ? n : last;
+			}
+		};
+		template <typename T>
+		struct FindElement<T, true>
+		{
+			using U = typename std::remove_cv<T>::type;
+			static inline size_t find_first(const T *p, size_t n, const T &c) noexcept { return find_first_eq<U>((const U*)p, n, c); }
+			static inline size_t find_last(const T *p, size_t n, const T &c) noexcept { return find_last_eq<U>((const U*)p, n, c); }
+		};
+
+#if defined(SLICE_SIMD_SSE2)
+		// find the first differing byte of two arrays; `bytes` must be at least one full vector
+		template <typename Vec>
+		inline size_t simd_mismatch(const char *a, const char *b, size_t bytes) noexcept
+		{
+			const uint64_t all = simd_lane_mask<Vec, 1>();
+			size_t i = 0;
+			for (; i + Vec::Width*2 <= bytes; i += Vec::Width*2)
+			{
+				typename Vec::M m0 = Vec::template cmpeq<1>(Vec::load(a + i), Vec::load(b + i));
+				typename Vec::M m1 = Vec::template cmpeq<1>(Vec::load(a + i + Vec::Width), Vec::load(b + i + Vec::Width));
+				if (Vec::template mask<1>(Vec::mand(m0, m1)) != all)
+				{
+					uint64_t bits = ~Vec::template mask<1>(m0) & all;
+					if (bits)
+						return i + ctz64(bits);
+					return i + Vec::Width + ctz64(~Vec::template mask<1>(m1) & all);
+				}
+			}
+			for (; i + Vec::Width <= bytes; i += Vec::Width)
+			{
+				uint64_t bits = ~Vec::template mask<1>(Vec::template cmpeq<1>(Vec::load(a + i), Vec::load(b + i))) & all;
+				if (bits)
+					return i + ctz64(bits);
+			}
+			if (i < bytes)
+			{
+				i = bytes - Vec::Width;
+				uint64_t bits = ~Vec::template mask<1>(Vec::template cmpeq<1>(Vec::load(a + i), Vec::load(b + i))) & all;
+				if (bits)
+					return i + ctz64(bits);
+			}
+			return bytes;
+		}
+
+		// index of the first differing element; short arrays compare 8 bytes at a time, which relies on x86 being
+		// little-endian to locate the first differing byte
+		template <typename U>
+		inline size_t mismatch(const U *a, const U *b, size_t n) noexcept
+		{
+			const size_t bytes = n*sizeof(U);
+			size_t i = bytes;
+# if defined(SLICE_SIMD_AVX512)
+			if (bytes >= Simd512::Width)
+				i = simd_mismatch<Simd512>((const char*)a, (const char*)b, bytes);
+			else
+# endif
+# if defined(SLICE_SIMD_AVX2)
+			if (bytes >= Simd256::Width)
+				i = simd_mismatch<Simd256>((const char*)a, (const char*)b, bytes);
+			else
+# endif
+			if (bytes >= Simd128::Width)
+				i = simd_mismatch<Simd128>((const char*)a, (const char*)b, bytes);
+			else if (bytes >= 8)
+			{
+				uint64_t x, y;
+				memcpy(&x, a, 8);
+				memcpy(&y, b, 8);
+				if (x != y)
+					i = ctz64(x ^ y) >> 3;
+				else
+				{
+					memcpy(&x, (const char*)a + bytes - 8, 8);
+					memcpy(&y, (const char*)b + bytes - 8, 8);
+					if (x != y)
+						i = bytes - 8 + (ctz64(x ^ y) >> 3);
+				}
+			}
+			else
+			{
+				for (size_t j = 0; j < n; ++j)
+				{
+					if (a[j] != b[j])
+						return j;
+				}
+				return n;
+			}
+			return i / sizeof(U);
+		}
+#else
+		template <typename U>
+		inline size_t mismatch(const U *a, const U *b, size_t n) noexcept
+		{
+			size_t i = 0;
+			while (i < n && a[i] == b[i])
+				++i;
+			return i;
+		}
+#endif
+
+		template <typename T, bool Simd>
+		struct CompareElements
+		{
+			static inline size_t mismatch(const T *a, const T *b, size_t n) noexcept
+			{
+				size_t i = 0;
+				while (i < n && !(a[i] != b[i]))
+					++i;
+				return i;
+			}
+		};
+		template <typename T>
+		struct CompareElements<T, true>
+		{
+			using U = typename SizedUint<sizeof(T)>::type;
+			static inline size_t mismatch(const T *a, const T *b, size_t n) noexcept { return a == b ? n : detail::mismatch<U>((const U*)a, (const U*)b, n); }
+		};
+
+		// Case-insensitive kernels for strings. Case folding is ASCII only (see to_lower()), so folding whole
+		// vectors with flip_case() agrees exactly with the scalar loops for every code unit, ASCII or not.
+		// A letter matches both of its cases when compared with the case bit set, since only that bit differs.
+#if defined(SLICE_SIMD_SSE2)
+		template <typename Vec, size_t Size>
+		inline size_t simd_mismatch_ic(const char *a, const char *b, size_t n) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const uint64_t all = simd_lane_mask<Vec, Size>();
+			size_t i = 0;
+			while (i < n)
+			{
+				if (i + Lanes > n)
+					i = n - Lanes; // overlap the final vector
+				typename Vec::V x = Vec::template flip_case<Size>(Vec::load(a + i*Size), 'A');
+				typename Vec::V y = Vec::template flip_case<Size>(Vec::load(b + i*Size), 'A');
+				uint64_t bits = ~Vec::template mask<Size>(Vec::template cmpeq<Size>(x, y)) & all;
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+				i += Lanes;
+			}
+			return n;
+		}
+		template <typename Vec, size_t Size>
+		inline size_t simd_find_first_ic(const char *p, size_t n, uint64_t letter) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const typename Vec::V caseBit = Vec::template splat<Size>(0x20), needle = Vec::template splat<Size>(letter);
+			size_t i = 0;
+			while (i < n)
+			{
+				if (i + Lanes > n)
+					i = n - Lanes;
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::vor(Vec::load(p + i*Size), caseBit), needle));
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+				i += Lanes;
+			}
+			return n;
+		}
+		template <typename Vec, size_t Size>
+		inline size_t simd_find_last_ic(const char *p, size_t n, uint64_t letter) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const typename Vec::V caseBit = Vec::template splat<Size>(0x20), needle = Vec::template splat<Size>(letter);
+			size_t i = n;
+			while (i > 0)
+			{
+				i = i >= Lanes ? i - Lanes : 0;
+				uint64_t bits = Vec::template mask<Size>(Vec::template cmpeq<Size>(Vec::vor(Vec::load(p + i*Size), caseBit), needle));
+				if (bits)
+					return i + bsr64(bits) / Vec::bits(Size);
+			}
+			return n;
+		}
+		// converting is idempotent, so the final vector may overlap elements which were already converted
+		template <typename Vec, size_t Size>
+		inline void simd_change_case(char *p, size_t n, uint64_t first) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			size_t i = 0;
+			while (i < n)
+			{
+				if (i + Lanes > n)
+					i = n - Lanes;
+				Vec::store(p + i*Size, Vec::template flip_case<Size>(Vec::load(p + i*Size), first));
+				i += Lanes;
+			}
+		}
+#endif
+
+		template <typename U>
+		inline size_t mismatch_ic(const U *a, const U *b, size_t n) noexcept
+		{
+			static_assert(sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4, "case-insensitive comparison is for 1, 2 and 4 byte code units");
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_mismatch_ic<Simd512, sizeof(U)>((const char*)a, (const char*)b, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_mismatch_ic<Simd256, sizeof(U)>((const char*)a, (const char*)b, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_mismatch_ic<Simd128, sizeof(U)>((const char*)a, (const char*)b, n);
+#endif
+			size_t i = 0;
+			while (i < n && to_lower(a[i]) == to_lower(b[i]))
+				++i;
+			return i;
+		}
+		template <typename U>
+		inline size_t find_first_ic(const U *p, size_t n, U c) noexcept
+		{
+			c = (U)to_lower(c);
+			if (c == to_upper(c))
+				return find_first_eq(p, n, c);
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_find_first_ic<Simd512, sizeof(U)>((const char*)p, n, c);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_find_first_ic<Simd256, sizeof(U)>((const char*)p, n, c);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_find_first_ic<Simd128, sizeof(U)>((const char*)p, n, c);
+#endif
+			size_t i = 0;
+			while (i < n && (U)(p[i] | 0x20) != c)
+				++i;
+			return i;
+		}
+		template <typename U>
+		inline size_t find_last_ic(const U *p, size_t n, U c) noexcept
+		{
+			c = (U)to_lower(c);
+			if (c == to_upper(c))
+				return find_last_eq(p, n, c);
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_find_last_ic<Simd512, sizeof(U)>((const char*)p, n, c);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_find_last_ic<Simd256, sizeof(U)>((const char*)p, n, c);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_find_last_ic<Simd128, sizeof(U)>((const char*)p, n, c);
+#endif
+			size_t i = n;
+			while (i > 0 && (U)(p[i - 1] | 0x20) != c)
+				--i;
+			return i > 0 ? i - 1 : n;
+		}
+		template <typename U, bool Upper>
+		inline void change_case(U *p, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_change_case<Simd512, sizeof(U)>((char*)p, n, Upper ? 'a' : 'A');
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_change_case<Simd256, sizeof(U)>((char*)p, n, Upper ? 'a' : 'A');
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_change_case<Simd128, sizeof(U)>((char*)p, n, Upper ? 'a' : 'A');
+#endif
+			for (size_t i = 0; i < n; ++i)
+				p[i] = (U)(Upper ? to_upper(p[i]) : to_lower(p[i]));
+		}
+
+		// membership tests for each CharClass, for single characters and for whole vectors
+		template <>
+		struct CharClassTest<CharClass::Whitespace>
+		{
+			static constexpr bool test(char32_t c) noexcept { return is_whitespace(c); }
+#if defined(SLICE_SIMD_SSE2)
+			template <typename Vec, size_t Size>
+			static inline typename Vec::M simd(typename Vec::V v) noexcept
+			{
+				// '\t' and '\n' are adjacent
+				return Vec::mor(Vec::mor(Vec::template in_range<Size>(v, '\t', 2), Vec::template cmpeq<Size>(v, Vec::template splat<Size>('\r'))),
+								Vec::template cmpeq<Size>(v, Vec::template splat<Size>(' ')));
+			}
+#endif
+		};
+		template <>
+		struct CharClassTest<CharClass::Digit>
+		{
+			static constexpr bool test(char32_t c) noexcept { return is_number(c); }
+#if defined(SLICE_SIMD_SSE2)
+			template <typename Vec, size_t Size>
+			static inline typename Vec::M simd(typename Vec::V v) noexcept { return Vec::template in_range<Size>(v, '0', 10); }
+#endif
+		};
+		template <>
+		struct CharClassTest<CharClass::Hex>
+		{
+			static constexpr bool test(char32_t c) noexcept { return is_hex(c); }
+#if defined(SLICE_SIMD_SSE2)
+			template <typename Vec, size_t Size>
+			static inline typename Vec::M simd(typename Vec::V v) noexcept
+			{
+				return Vec::mor(Vec::template in_range<Size>(v, '0', 10), Vec::template in_range<Size>(Vec::vor(v, Vec::template splat<Size>(0x20)), 'a', 6));
+			}
+#endif
+		};
+		template <>
+		struct CharClassTest<CharClass::Alnum>
+		{
+			static constexpr bool test(char32_t c) noexcept { return is_alnum(c); }
+#if defined(SLICE_SIMD_SSE2)
+			template <typename Vec, size_t Size>
+			static inline typename Vec::M simd(typename Vec::V v) noexcept
+			{
+				return Vec::mor(Vec::template in_range<Size>(v, '0', 10), Vec::template in_range<Size>(Vec::vor(v, Vec::template splat<Size>(0x20)), 'a', 26));
+			}
+#endif
+		};
+
+#if defined(SLICE_SIMD_SSE2)
+		// find the first/last element which is (In), or is not, in a class; `p` must hold at least one full vector
+		template <typename Vec, size_t Size, typename Class, bool In>
+		inline size_t simd_find_first_class(const char *p, size_t n) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const uint64_t all = simd_lane_mask<Vec, Size>();
+			size_t i = 0;
+			while (i < n)
+			{
+				if (i + Lanes > n)
+					i = n - Lanes;
+				uint64_t bits = Vec::template mask<Size>(Class::template simd<Vec, Size>(Vec::load(p + i*Size)));
+				if (!In)
+					bits = ~bits & all;
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+				i += Lanes;
+			}
+			return n;
+		}
+		template <typename Vec, size_t Size, typename Class, bool In>
+		inline size_t simd_find_last_class(const char *p, size_t n) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const uint64_t all = simd_lane_mask<Vec, Size>();
+			size_t i = n;
+			while (i > 0)
+			{
+				i = i >= Lanes ? i - Lanes : 0;
+				uint64_t bits = Vec::template mask<Size>(Class::template simd<Vec, Size>(Vec::load(p + i*Size)));
+				if (!In)
+					bits = ~bits & all;
+				if (bits)
+					return i + bsr64(bits) / Vec::bits(Size);
+			}
+			return n;
+		}
+#endif
+
+		template <typename U, CharClass Class, bool In>
+		inline size_t find_first_class(const U *p, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_find_first_class<Simd512, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_find_first_class<Simd256, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_find_first_class<Simd128, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+			size_t i = 0;
+			while (i < n && CharClassTest<Class>::test(p[i]) != In)
+				++i;
+			return i;
+		}
+		template <typename U, CharClass Class, bool In>
+		inline size_t find_last_class(const U *p, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(U))
+				return simd_find_last_class<Simd512, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(U))
+				return simd_find_last_class<Simd256, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(U))
+				return simd_find_last_class<Simd128, sizeof(U), CharClassTest<Class>, In>((const char*)p, n);
+#endif
+			size_t i = n;
+			while (i > 0 && CharClassTest<Class>::test(p[i - 1]) != In)
+				--i;
+			return i > 0 ? i - 1 : n;
+		}
+	}
+	template <typename T, bool S>
+	inline size_t Slice<T, S>::find_first(const typename Slice<T, S>::value_type &c) const noexcept
+	{
+		return detail::FindElement<typename Slice<T, S>::value_type>::find_first((const value_type*)ptr, length, c);
+	}
+	template <typename T, bool S>
+	inline size_t Slice<T, S>::find_last(const typename Slice<T, S>::value_type &c) const noexcept
+	{
+		return detail::FindElement<typename Slice<T, S>::value_type>::find_last((const value_type*)ptr, length, c);
+	}
+	namespace detail
+	{
+		template <size_t Size> struct SizedUint;
+		template <> struct SizedUint<1> { using type = uint8_t; };
+		template <> struct SizedUint<2> { using type = uint16_t; };
+		template <> struct SizedUint<4> { using type = uint32_t; };
+		template <> struct SizedUint<8> { using type = uint64_t; };
+
+		// element accessors, so that the same matcher can search forwards or backwards, and optionally case-folded
+		template <typename U, bool IgnoreCase = false>
+		struct ForwardSeq
+		{
+			const U *p;
+			size_t n;
+			U operator[](size_t i) const noexcept { return IgnoreCase ? (U)to_lower(p[i]) : p[i]; }
+		};
+		template <typename U, bool IgnoreCase = false>
+		struct ReverseSeq
+		{
+			const U *p;
+			size_t n;
+			U operator[](size_t i) const noexcept { return IgnoreCase ? (U)to_lower(p[n - 1 - i]) : p[n - 1 - i]; }
+		};
+
+		// Crochemore-Perrin two-way string matching; linear time and constant space.
+		// Windows are first filtered with a Horspool bad-character shift on their last element, which skips most
+		// of the haystack for long needles. Wide elements share shift table entries by their low byte.
+		template <typename U>
+		struct TwoWay
+		{
+			ptrdiff_t ell;
+			size_t period;
+			bool periodic;
+			uint8_t shift[256];
+
+			template <typename Seq>
+			static ptrdiff_t max_suffix(Seq x, size_t m, size_t &p, bool invert) noexcept
+			{
+				ptrdiff_t ms = -1;
+				size_t j = 0, k = 1;
+				p = 1;
+				while (j + k < m)
+				{
+					U a = x[j + k], b = x[ms + k];
+					if (invert ? a > b : a < b)
+					{
+						j += k;
+						k = 1;
+						p = j - ms;
+					}
+					else if (a == b)
+					{
+						if (k != p)
+							++k;
+						else
+						{
+							j += p;
+							k = 1;
+						}
+					}
+					else
+					{
+						ms = j;
+						j = ms + 1;
+						k = p = 1;
+					}
+				}
+				return ms;
+			}
+
+			template <typename Seq>
+			void init(Seq x) noexcept
+			{
+				size_t m = x.n, p, q;
+				ptrdiff_t i = max_suffix(x, m, p, false);
+				ptrdiff_t j = max_suffix(x, m, q, true);
+				if (i > j)
+				{
+					ell = i;
+					period = p;
+				}
+				else
+				{
+					ell = j;
+					period = q;
+				}
+				periodic = true;
+				for (ptrdiff_t k = 0; k <= ell; ++k)
+				{
+					if (x[k] != x[k + period])
+					{
+						periodic = false;
+						break;
+					}
+				}
+				if (!periodic)
+					period = (size_t)(ell + 1 > (ptrdiff_t)m - ell - 1 ? ell + 1 : (ptrdiff_t)m - ell - 1) + 1;
+
+				memset(shift, m < 255 ? (int)m : 255, sizeof(shift));
+				for (size_t k = 0; k < m; ++k)
+					shift[(uint8_t)x[k]] = (uint8_t)(m - 1 - k < 255 ? m - 1 - k : 255);
+			}
+
+			// returns the offset of the first match in y, or y.n
+			template <typename Seq>
+			size_t find(Seq x, Seq y) const noexcept
+			{
+				const ptrdiff_t m = x.n;
+				const size_t n = y.n;
+				ptrdiff_t memory = -1;
+				size_t j = 0;
+				while (j + m <= n)
+				{
+					size_t s = shift[(uint8_t)y[j + m - 1]];
+					if (s)
+					{
+						j += s;
+						memory = -1;
+						continue;
+					}
+					ptrdiff_t i = (periodic && memory > ell ? memory : ell) + 1;
+					while (i < m && x[i] == y[i + j])
+						++i;
+					if (i < m)
+					{
+						j += i - ell;
+						memory = -1;
+						continue;
+					}
+					ptrdiff_t low = periodic ? memory : -1;
+					i = ell;
+					while (i > low && x[i] == y[i + j])
+						--i;
+					if (i <= low)
+						return j;
+					j += period;
+					if (periodic)
+						memory = m - period - 1;
+				}
+				return n;
+			}
+		};
+
+		template <typename U>
+		inline bool range_eq(const U *a, const U *b, size_t n, std::false_type) noexcept
+		{
+			return memcmp(a, b, n*sizeof(U)) == 0;
+		}
+		template <typename U>
+		inline bool range_eq(const U *a, const U *b, size_t n, std::true_type) noexcept
+		{
+			return mismatch_ic(a, b, n) == n;
+		}
+		template <typename U, bool IgnoreCase>
+		inline bool range_eq(const U *a, const U *b, size_t n) noexcept
+		{
+			return range_eq(a, b, n, std::integral_constant<bool, IgnoreCase>());
+		}
+
+		// "generic SIMD" substring search: compare the first and last element of the needle against a vector of
+		// candidate positions at once, then verify only the candidates that match both.
+		// When ignoring case, `x` must be lower case, and candidates are compared against both cases.
+		template <typename Vec, size_t Size, bool IgnoreCase>
+		struct SimdSubstr
+		{
+			using U = typename SizedUint<Size>::type;
+			enum { Lanes = Vec::Width / Size };
+
+			typename Vec::V first, firstAlt, last, lastAlt;
+
+			SimdSubstr(const U *x, size_t m) noexcept
+				: first(Vec::template splat<Size>(x[0])), firstAlt(Vec::template splat<Size>(IgnoreCase ? to_upper(x[0]) : x[0]))
+				, last(Vec::template splat<Size>(x[m - 1])), lastAlt(Vec::template splat<Size>(IgnoreCase ? to_upper(x[m - 1]) : x[m - 1])) {}
+
+			inline uint64_t candidates(const U *y, size_t m) const noexcept
+			{
+				typename Vec::V a = Vec::load(y), b = Vec::load(y + m - 1);
+				typename Vec::M f = Vec::template cmpeq<Size>(a, first);
+				typename Vec::M l = Vec::template cmpeq<Size>(b, last);
+				if (IgnoreCase)
+				{
+					f = Vec::mor(f, Vec::template cmpeq<Size>(a, firstAlt));
+					l = Vec::mor(l, Vec::template cmpeq<Size>(b, lastAlt));
+				}
+				return Vec::template mask<Size>(Vec::mand(f, l));
+			}
+
+			size_t find_first(const U *y, size_t n, const U *x, size_t m) const noexcept
+			{
+				const uint64_t elementMask = ((uint64_t)2 << (Vec::bits(Size) - 1)) - 1;
+				const size_t positions = n - m + 1, verify = m < 2 ? 0 : m - 2;
+				size_t i = 0;
+				while (i < positions)
+				{
+					if (i + Lanes > positions)
+						i = positions - Lanes; // overlap the final vector
+					uint64_t bits = candidates(y + i, m);
+					while (bits)
+					{
+						unsigned b = ctz64(bits);
+						size_t k = i + b / Vec::bits(Size);
+						if (range_eq<U, IgnoreCase>(y + k + 1, x + 1, verify))
+							return k;
+						bits &= ~(elementMask << b);
+					}
+					i += Lanes;
+				}
+				return n;
+			}
+			size_t find_last(const U *y, size_t n, const U *x, size_t m) const noexcept
+			{
+				const uint64_t elementMask = ((uint64_t)2 << (Vec::bits(Size) - 1)) - 1;
+				const size_t verify = m < 2 ? 0 : m - 2;
+				size_t i = n - m + 1;
+				while (i > 0)
+				{
+					i = i >= Lanes ? i - Lanes : 0; // overlap the final vector
+					uint64_t bits = candidates(y + i, m);
+					while (bits)
+					{
+						unsigned b = bsr64(bits) + 1 - (unsigned)Vec::bits(Size);
+						size_t k = i + b / Vec::bits(Size);
+						if (range_eq<U, IgnoreCase>(y + k + 1, x + 1, verify))
+							return k;
+						bits &= ~(elementMask << b);
+					}
+				}
+				return n;
+			}
+		};
+
+		// needles up to this length use the SIMD filter; longer needles use two-way
+		enum { ShortNeedleLength = 32 };
+
+		enum SearchDirection
+		{
+			SearchForward = 1,
+			SearchReverse = 2
+		};
+
+		// precomputed state to search for a needle of unsigned elements; tables are only built for the directions
+		// requested by init()
+		template <typename U, bool IgnoreCase>
+		struct SubstrSearch
+		{
+			const U *x;
+			size_t m;
+			U lower[2];
+			TwoWay<U> fwd, rev;
+
+			void init(const U *needle, size_t len, int directions) noexcept
+			{
+				x = needle;
+				m = len;
+				if (m == 0)
+					return;
+				if (IgnoreCase)
+				{
+					// the SIMD filter wants the first and last elements in lower case
+					lower[0] = (U)to_lower(x[0]);
+					lower[1] = (U)to_lower(x[m - 1]);
+				}
+				if (m <= ShortNeedleLength)
+					return;
+				if (directions & SearchForward)
+					fwd.init(ForwardSeq<U, IgnoreCase>{ x, m });
+				if (directions & SearchReverse)
+					rev.init(ReverseSeq<U, IgnoreCase>{ x, m });
+			}
+
+			size_t find_first(const U *y, size_t n) const noexcept
+			{
+				if (m == 0)
+					return 0;
+				if (m > n)
+					return n;
+				if (m > ShortNeedleLength)
+					return fwd.find(ForwardSeq<U, IgnoreCase>{ x, m }, ForwardSeq<U, IgnoreCase>{ y, n });
+				if (!IgnoreCase && m == 1)
+					return find_first_eq(y, n, x[0]);
+				size_t positions = n - m + 1;
+				(void)positions;
+#if defined(SLICE_SIMD_AVX512)
+				if (positions >= Simd512::Width / sizeof(U))
+					return simd<Simd512>().find_first(y, n, x, m);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+				if (positions >= Simd256::Width / sizeof(U))
+					return simd<Simd256>().find_first(y, n, x, m);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+				if (positions >= Simd128::Width / sizeof(U))
+					return simd<Simd128>().find_first(y, n, x, m);
+#endif
+				// scan for the first element, then verify the rest
+				for (size_t i = 0; i + m <= n; ++i)
+				{
+					if (!IgnoreCase)
+					{
+						i += find_first_eq(y + i, n - m + 1 - i, x[0]);
+						if (i + m > n)
+							break;
+					}
+					else if (to_lower(y[i]) != lower[0])
+						continue;
+					if (range_eq<U, IgnoreCase>(y + i + 1, x + 1, m - 1))
+						return i;
+				}
+				return n;
+			}
+			size_t find_last(const U *y, size_t n) const noexcept
+			{
+				if (m == 0)
+					return n;
+				if (m > n)
+					return n;
+				if (m > ShortNeedleLength)
+				{
+					size_t r = rev.find(ReverseSeq<U, IgnoreCase>{ x, m }, ReverseSeq<U, IgnoreCase>{ y, n });
+					return r == n ? n : n - r - m;
+				}
+				if (!IgnoreCase && m == 1)
+					return find_last_eq(y, n, x[0]);
+				size_t positions = n - m + 1;
+				(void)positions;
+#if defined(SLICE_SIMD_AVX512)
+				if (positions >= Simd512::Width / sizeof(U))
+					return simd<Simd512>().find_last(y, n, x, m);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+				if (positions >= Simd256::Width / sizeof(U))
+					return simd<Simd256>().find_last(y, n, x, m);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+				if (positions >= Simd128::Width / sizeof(U))
+					return simd<Simd128>().find_last(y, n, x, m);
+#endif
+				for (size_t i = n - m + 1; i > 0; --i)
+				{
+					size_t k = i - 1;
+					if (!IgnoreCase)
+					{
+						k = find_last_eq(y, i, x[0]);
+						if (k == i)
+							break;
+					}
+					else if (to_lower(y[k]) != lower[0])
+						continue;
+					if (range_eq<U, IgnoreCase>(y + k + 1, x + 1, m - 1))
+						return k;
+					i = k + 1;
+				}
+				return n;
+			}
+
+		private:
+			template <typename Vec>
+			SimdSubstr<Vec, sizeof(U), IgnoreCase> simd() const noexcept
+			{
+				return IgnoreCase ? SimdSubstr<Vec, sizeof(U), IgnoreCase>(lower, 2) : SimdSubstr<Vec, sizeof(U), IgnoreCase>(x, m);
+			}
+		};
+
+		template <typename T, bool Simd = IsSimdComparable<T>::value>
+		struct FindSlice
+		{
+			static inline size_t find_first(const T *y, size_t n, const T *x, size_t m) noexcept
+			{
+				for (size_t i = 0; i + m <= n; ++i)
+				{
+					size_t j = 0;
+					for (; j < m; ++j)
+					{
+						if (!FindImpl<T>::eq(y[i + j], x[j]))
+							break;
+					}
+					if (j == m)
+						return i;
+				}
+				return n;
+			}
+			static inline size_t find_last(const T *y, size_t n, const T *x, size_t m) noexcept
+			{
+				for (size_t i = n - m + 1; m <= n && i > 0; --i)
+				{
+					size_t j = 0;
+					for (; j < m; ++j)
+					{
+						if (!FindImpl<T>::eq(y[i - 1 + j], x[j]))
+							break;
+					}
+					if (j == m)
+						return i - 1;
+				}
+				return n;
+			}
+		};
+		template <typename T>
+		struct FindSlice<T, true>
+		{
+			using U = typename SizedUint<sizeof(T)>::type;
+			static inline size_t find_first(const T *y, size_t n, const T *x, size_t m) noexcept
+			{
+				SubstrSearch<U, false> search;
+				search.init((const U*)x, m, SearchForward);
+				return search.find_first((const U*)y, n);
+			}
+			static inline size_t find_last(const T *y, size_t n, const T *x, size_t m) noexcept
+			{
+				SubstrSearch<U, false> search;
+				search.init((const U*)x, m, SearchReverse);
+				return search.find_last((const U*)y, n);
+			}
+		};
+	}
+	template <typename T, bool S>
+	inline size_t Slice<T, S>::find_first(Slice<const T> s) const noexcept
+	{
+		if (s.empty())
+			return 0;
+		return detail::FindSlice<typename Slice<T, S>::value_type>::find_first((const value_type*)ptr, length, (const value_type*)s.ptr, s.length);
+	}
+	template <typename T, bool S>
+	inline size_t Slice<T, S>::find_last(Slice<const T> s) const noexcept
+	{
+		if (s.empty())
+			return length;
+		return detail::FindSlice<typename Slice<T, S>::value_type>::find_last((const value_type*)ptr, length, (const value_type*)s.ptr, s.length);
+	}
+
+#if !defined(NO_STL)
+	template <typename T, bool S>
+	inline T* Slice<T, S>::search(std::function<bool(const_reference e)> pred) const noexcept
+	{
+		return search<std::function<bool(const_reference e)>&>(pred);
+	}
+#endif
+	template <typename T, bool S>
+	template <typename Predicate>
+	inline auto Slice<T, S>::search(Predicate &&pred) const noexcept -> decltype(bool(pred(std::declval<const_reference>())), (T*)nullptr)
+	{
+		for (size_t i = 0; i < length; ++i)
+		{
+			if (pred(ptr[i]))
+				return ptr + i;
+		}
+		return nullptr;
+	}
+
+	template <typename T, bool S>
+	inline ptrdiff_t Slice<T, S>::index_of_element(const T *c) const noexcept
+	{
+		if (c >= ptr && c < ptr + length)
+			return c - ptr;
+		return -1;
+	}
+
+	template <typename T, bool S>
+	inline void Slice<T, S>::replace(const_reference oldval, const_reference newval) const
+	{
+		for (size_t i = 0; i < length; ++i)
+			if (ptr[i] == oldval)
+				ptr[i] = newval;
+	}
+
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_left_at_first(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
+	{
+		size_t offset = find_first(c);
+		if (offset != this->length)
+			offset += inclusive ? 1 : 0;
+		return{ this->ptr, offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_left_at_last(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
+	{
+		size_t offset = find_last(c);
+		if (offset != this->length)
+			offset += inclusive ? 1 : 0;
+		return{ this->ptr, offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_right_at_first(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
+	{
+		size_t offset = find_first(c);
+		if (offset != this->length)
+			offset += inclusive ? 0 : 1;
+		return{ this->ptr + offset, length - offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_right_at_last(const typename Slice<T, S>::value_type &c, bool inclusive) const noexcept
+	{
+		size_t offset = find_last(c);
+		if (offset != this->length)
+			offset += inclusive ? 0 : 1;
+		return{ this->ptr + offset, length - offset };
+	}
+
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_left_at_first(Slice<const T> s, bool inclusive) const noexcept
+	{
+		size_t offset = find_first(s);
+		if (offset != this->length)
+			offset += inclusive ? s.length : 0;
+		return{ this->ptr, offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_left_at_last(Slice<const T> s, bool inclusive) const noexcept
+	{
+		size_t offset = find_last(s);
+		if (offset != this->length)
+			offset += inclusive ? s.length : 0;
+		return{ this->ptr, offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_right_at_first(Slice<const T> s, bool inclusive) const noexcept
+	{
+		size_t offset = find_first(s);
+		if (offset != this->length)
+			offset += inclusive ? 0 : s.length;
+		return{ this->ptr + offset, length - offset };
+	}
+	template <typename T, bool S>
+	inline Slice<T> Slice<T, S>::get_right_at_last(Slice<const T> s, bool inclusive) const noexcept
+	{
+		size_t offset = find_last(s);
+		if (offset != this->length)
+			offset += inclusive ? 0 : s.length;
+		return{ this->ptr + offset, length - offset };
+	}
+
+	template <typename T, bool S>
+	template <typename U>
+	inline size_t Slice<T, S>::copy_to(Slice<U> dest) const noexcept
+	{
+		SLICE_ASSERT(dest.length >= length);
+		for (size_t i = 0; i < length; ++i)
+			dest.ptr[i] = ptr[i];
+		return length;
+	}
+
+	namespace detail
+	{
+		// integers that can be classified through a table; wider types and non-integers search the set
+		template <typename T>
+		struct IsDelimiterTable
+		{
+			using U = typename std::remove_cv<T>::type;
+			enum { value = std::is_integral<U>::value && (sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4) };
+		};
+
+#if defined(SLICE_SIMD_SSE2)
+		// matches elements equal to any of up to N values; shorter sets repeat their first value
+		template <typename Vec, size_t Size, size_t N>
+		struct SimdAnyOf
+		{
+			typename Vec::V values[N];
+
+			SimdAnyOf(const char *set, size_t count) noexcept
+			{
+				for (size_t i = 0; i < N; ++i)
+				{
+					uint64_t v = 0;
+					memcpy(&v, set + (i < count ? i : 0)*Size, Size);
+					values[i] = Vec::template splat<Size>(v);
+				}
+			}
+			uint64_t match(const char *p) const noexcept
+			{
+				typename Vec::V v = Vec::load(p);
+				typename Vec::M m = Vec::template cmpeq<Size>(v, values[0]);
+				for (size_t i = 1; i < N; ++i)
+					m = Vec::mor(m, Vec::template cmpeq<Size>(v, values[i]));
+				return Vec::template mask<Size>(m);
+			}
+		};
+
+		// matches bytes by looking up each nibble in a 16 entry table of bucket bits; a byte is a member when its
+		// low and high nibbles share a bucket
+		template <typename Vec>
+		struct SimdShufti
+		{
+			typename Vec::V lo, hi, nibble;
+
+			SimdShufti(const uint8_t *loTable, const uint8_t *hiTable) noexcept
+				: lo(Vec::broadcast16(loTable)), hi(Vec::broadcast16(hiTable)), nibble(Vec::template splat<1>(0x0F)) {}
+
+			uint64_t match(const char *p) const noexcept
+			{
+				typename Vec::V v = Vec::load(p);
+				typename Vec::V l = Vec::shuffle(lo, Vec::vand(v, nibble));
+				typename Vec::V h = Vec::shuffle(hi, Vec::vand(Vec::srli4(v), nibble));
+				return ~Vec::template mask<1>(Vec::template cmpeq<1>(Vec::vand(l, h), Vec::zero())) & simd_lane_mask<Vec, 1>();
+			}
+		};
+
+		// find the first element which is (or is not) matched; `p` must hold at least one full vector of elements
+		template <typename Vec, size_t Size, bool Members, typename Matcher>
+		inline size_t simd_find_match(const char *p, size_t n, const Matcher &matcher) noexcept
+		{
+			enum { Lanes = Vec::Width / Size };
+			const uint64_t invert = Members ? 0 : simd_lane_mask<Vec, Size>();
+			size_t i = 0;
+			for (; i + Lanes <= n; i += Lanes)
+			{
+				uint64_t bits = matcher.match(p + i*Size) ^ invert;
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+			}
+			if (i < n)
+			{
+				i = n - Lanes;
+				uint64_t bits = matcher.match(p + i*Size) ^ invert;
+				if (bits)
+					return i + ctz64(bits) / Vec::bits(Size);
+			}
+			return n;
+		}
+#endif
+
+		// compiled delimiter set for unsigned elements; values < 256 are tested in a bitmap, which also generates the
+		// nibble tables for the SIMD classifier
+		template <typename U>
+		struct DelimiterTable
+		{
+			const U *x;
+			size_t k;
+			uint64_t bits[4];
+			U wideMin, wideMax;
+			bool shufti;
+			uint8_t lo[16], hi[16];
+
+			void init(const U *delimiters, size_t len) noexcept;
+
+			bool contains(U c) const noexcept
+			{
+				if (sizeof(U) == 1 || c < 256)
+					return (bits[(c >> 6) & 3] >> (c & 63)) & 1;
+				if (c < wideMin || c > wideMax)
+					return false;
+				for (size_t i = 0; i < k; ++i)
+				{
+					if (x[i] == c)
+						return true;
+				}
+				return false;
+			}
+
+			template <bool Members>
+			size_t find(const U *p, size_t n) const noexcept
+			{
+				if (k == 0)
+					return Members ? n : 0;
+#if defined(SLICE_SIMD_AVX512)
+				if (n >= Simd512::Width / sizeof(U))
+					return find_simd<Simd512, Members>(p, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+				if (n >= Simd256::Width / sizeof(U))
+					return find_simd<Simd256, Members>(p, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+				if (n >= Simd128::Width / sizeof(U))
+					return find_simd<Simd128, Members>(p, n);
+#endif
+				return find_scalar<Members>(p, n);
+			}
+
+		private:
+			template <bool Members>
+			size_t find_scalar(const U *p, size_t n) const noexcept
+			{
+				size_t i = 0;
+				while (i < n && contains(p[i]) != Members)
+					++i;
+				return i;
+			}
+#if defined(SLICE_SIMD_SSE2)
+			template <typename Vec, bool Members>
+			size_t find_simd(const U *p, size_t n) const noexcept
+			{
+				if (shufti)
+					return find_shufti<Vec, Members>(p, n, std::integral_constant<bool, sizeof(U) == 1 && Vec::HasShuffle>());
+				return find_any_of<Vec, Members>(p, n);
+			}
+			template <typename Vec, bool Members>
+			size_t find_shufti(const U *p, size_t n, std::true_type) const noexcept
+			{
+				return simd_find_match<Vec, 1, Members>((const char*)p, n, SimdShufti<Vec>(lo, hi));
+			}
+			template <typename Vec, bool Members>
+			size_t find_shufti(const U *p, size_t n, std::false_type) const noexcept
+			{
+				return find_any_of<Vec, Members>(p, n);
+			}
+			template <typename Vec, bool Members>
+			size_t find_any_of(const U *p, size_t n) const noexcept
+			{
+				if (k <= 4)
+					return simd_find_match<Vec, sizeof(U), Members>((const char*)p, n, SimdAnyOf<Vec, sizeof(U), 4>((const char*)x, k));
+				if (k <= 8)
+					return simd_find_match<Vec, sizeof(U), Members>((const char*)p, n, SimdAnyOf<Vec, sizeof(U), 8>((const char*)x, k));
+				return find_scalar<Members>(p, n);
+			}
+#endif
+		};
+
+		template <typename U>
+		inline void DelimiterTable<U>::init(const U *delimiters, size_t len) noexcept
+		{
+			x = delimiters;
+			k = len;
+			memset(bits, 0, sizeof(bits));
+			wideMin = (U)~(U)0;
+			wideMax = 0;
+			for (size_t i = 0; i < len; ++i)
+			{
+				U c = delimiters[i];
+				if (sizeof(U) == 1 || c < 256)
+					bits[(c >> 6) & 3] |= 1ull << (c & 63);
+				else
+				{
+					wideMin = c < wideMin ? c : wideMin;
+					wideMax = c > wideMax ? c : wideMax;
+				}
+			}
+
+			// assign a bucket to each distinct row of 16 values; the set is only suitable when there are at most 8
+			memset(lo, 0, sizeof(lo));
+			memset(hi, 0, sizeof(hi));
+			shufti = sizeof(U) == 1;
+			uint16_t rows[8];
+			unsigned numBuckets = 0;
+			for (unsigned h = 0; h < 16 && shufti; ++h)
+			{
+				uint16_t row = (uint16_t)(bits[h >> 2] >> ((h & 3) * 16));
+				if (!row)
+					continue;
+				unsigned b = 0;
+				while (b < numBuckets && rows[b] != row)
+					++b;
+				if (b == numBuckets)
+				{
+					if (numBuckets == 8)
+					{
+						shufti = false;
+						break;
+					}
+					rows[numBuckets++] = row;
+					for (unsigned l = 0; l < 16; ++l)
+					{
+						if ((row >> l) & 1)
+							lo[l] |= (uint8_t)(1 << b);
+					}
+				}
+				hi[h] = (uint8_t)(1 << b);
+			}
+		}
+
+		template <typename C>
+		inline const DelimiterSet<typename std::remove_const<C>::type>& whitespace_delimiters() noexcept
+		{
+			using U = typename std::remove_const<C>::type;
+			static const U whitespace[] = { ' ', '\t', '\n', '\r' };
+			static const DelimiterSet<U> delimiters(Slice<const U>(whitespace, 4));
+			return delimiters;
+		}
+	}
+
+	template <typename T>
+	inline DelimiterSet<T>::DelimiterSet(Slice<const value_type> delimiters) noexcept
+	{
+		using U = typename std::remove_const<typename std::remove_pointer<decltype(impl.x)>::type>::type;
+		impl.init((const U*)delimiters.ptr, delimiters.length);
+	}
+	template <typename T>
+	inline bool DelimiterSet<T>::contains(const value_type &c) const noexcept
+	{
+		using U = typename std::remove_const<typename std::remove_pointer<decltype(impl.x)>::type>::type;
+		return impl.contains((const U&)c);
+	}
+	template <typename T>
+	inline size_t DelimiterSet<T>::find_first_of(Slice<const value_type> s) const noexcept
+	{
+		using U = typename std::remove_const<typename std::remove_pointer<decltype(impl.x)>::type>::type;
+		return impl.template find<true>((const U*)s.ptr, s.length);
+	}
+	template <typename T>
+	inline size_t DelimiterSet<T>::find_first_not_of(Slice<const value_type> s) const noexcept
+	{
+		using U = typename std::remove_const<typename std::remove_pointer<decltype(impl.x)>::type>::type;
+		return impl.template find<false>((const U*)s.ptr, s.length);
+	}
+	template <typename T>
+	template <typename U, bool Table>
+	inline bool DelimiterSet<T>::Impl<U, Table>::contains(const U &c) const noexcept
+	{
+		for (size_t i = 0; i < k; ++i)
+		{
+			if (detail::FindImpl<U>::eq(x[i], c))
+				return true;
+		}
+		return false;
+	}
+	template <typename T>
+	template <typename U, bool Table>
+	template <bool Members>
+	inline size_t DelimiterSet<T>::Impl<U, Table>::find(const U *p, size_t n) const noexcept
+	{
+		size_t i = 0;
+		while (i < n && contains(p[i]) != Members)
+			++i;
+		return i;
+	}
+
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens>
+	inline Slice<T> Slice<T, S>::pop_token(Slice<const T> delimiters) noexcept
+	{
+		// a single token is too short to pay for building a DelimiterSet
+		size_t offset = 0;
+		if (SkipEmptyTokens)
+		{
+			while (offset < length && delimiters.contains(ptr[offset]))
+				++offset;
+		}
+		size_t end = offset;
+		while (end < length && !delimiters.contains(ptr[end]))
+			++end;
+		Slice<T> token = slice(offset, end);
+		if (end < length)
+			++end;
+		ptr += end;
+		length -= end;
+		return token;
+	}
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens>
+	inline Slice<T> Slice<T, S>::pop_token(const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) noexcept
+	{
+		size_t offset = 0;
+		if (SkipEmptyTokens)
+			offset = delimiters.find_first_not_of(*this);
+		size_t end = offset + delimiters.find_first_of(slice(offset, length));
+		Slice<T> token = slice(offset, end);
+		if (end < length)
+			++end;
+		ptr += end;
+		length -= end;
+		return token;
+	}
 
 	template <typename T, bool S>
 	template <bool SkipEmptyTokens>
-	inline Slice<Slice<T>> Slice<T, S>::tokenise(Slice<Slice<T>> tokens, Slice<const T> delimiters) noexcept
+	inline Slice<Slice<T>> Slice<T, S>::tokenise(Slice<Slice<T>> tokens, Slice<const T> delimiters) noexcept
+	{
+		return tokenise<SkipEmptyTokens>(tokens, DelimiterSet<typename std::remove_const<value_type>::type>(delimiters));
+	}
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens>
+	inline Slice<Slice<T>> Slice<T, S>::tokenise(Slice<Slice<T>> tokens, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) noexcept
+	{
+		size_t numTokens = 0;
+		size_t offset = 0;
+		while (offset < length && numTokens < tokens.length)
+		{
+			if (!SkipEmptyTokens)
+			{
+				size_t tokStart = offset;
+				offset += delimiters.find_first_of(slice(offset, length));
+				tokens[numTokens++] = slice(tokStart, offset);
+				++offset;
+			}
+			else
+			{
+				offset += delimiters.find_first_not_of(slice(offset, length));
+				if (offset == length)
+					break;
+				size_t tokStart = offset;
+				offset += delimiters.find_first_of(slice(offset, length));
+				tokens[numTokens++] = slice(tokStart, offset);
+			}
+		}
+		if (!SkipEmptyTokens && offset > length)
+			offset = length;
+		ptr += offset;
+		length -= offset;
+		return tokens.front(numTokens);
+	}
+#if !defined(NO_STL)
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens>
+	inline size_t Slice<T, S>::tokenise(std::function<void(Slice<T> token, size_t index)> onToken, Slice<const T> delimiters) const noexcept
+	{
+		return tokenise<SkipEmptyTokens, std::function<void(Slice<T> token, size_t index)>&>(onToken, delimiters);
+	}
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens>
+	inline size_t Slice<T, S>::tokenise(std::function<void(Slice<T> token, size_t index)> onToken, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept
+	{
+		return tokenise<SkipEmptyTokens, std::function<void(Slice<T> token, size_t index)>&>(onToken, delimiters);
+	}
+#endif
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens, typename Callback>
+	inline auto Slice<T, S>::tokenise(Callback &&onToken, Slice<const T> delimiters) const noexcept -> decltype(onToken(Slice<T>(), size_t()), size_t())
+	{
+		return tokenise<SkipEmptyTokens, Callback>(std::forward<Callback>(onToken), DelimiterSet<typename std::remove_const<value_type>::type>(delimiters));
+	}
+	template <typename T, bool S>
+	template <bool SkipEmptyTokens, typename Callback>
+	inline auto Slice<T, S>::tokenise(Callback &&onToken, const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept -> decltype(onToken(Slice<T>(), size_t()), size_t())
 	{
 		size_t numTokens = 0;
 		size_t offset = 0;
-		while (offset < length && numTokens < tokens.length)
+		while (offset < length)
+		{
+			if (!SkipEmptyTokens)
+			{
+				size_t tokStart = offset;
+				offset += delimiters.find_first_of(slice(offset, length));
+				onToken(slice(tokStart, offset++), numTokens++);
+			}
+			else
+			{
+				offset += delimiters.find_first_not_of(slice(offset, length));
+				if (offset == length)
+					break;
+				size_t tokStart = offset;
+				offset += delimiters.find_first_of(slice(offset, length));
+				onToken(slice(tokStart, offset), numTokens++);
+			}
+		}
+		return numTokens;
+	}
+
+	namespace detail
+	{
+		// each splitter takes the next token from the front of `rest`, and returns false if there are no more.
+		// `more` is cleared once a token has been taken which was not followed by a separator
+		template <typename T>
+		struct TokenSplitter
+		{
+			DelimiterSet<typename std::remove_const<typename SliceElementType<T>::Ty>::type> delimiters;
+
+			bool next(Slice<T> &rest, bool &, Slice<T> &token) const noexcept
+			{
+				token = rest.template pop_token<true>(delimiters);
+				return token.length != 0;
+			}
+		};
+		template <typename T>
+		struct ElementSplitter
+		{
+			typename std::remove_const<typename SliceElementType<T>::Ty>::type separator;
+
+			bool next(Slice<T> &rest, bool &more, Slice<T> &token) const noexcept
+			{
+				if (!more)
+					return false;
+				size_t i = rest.find_first(separator);
+				token = rest.slice(0, i);
+				more = i < rest.length;
+				rest = rest.slice(more ? i + 1 : i, rest.length);
+				return true;
+			}
+		};
+		template <typename T>
+		struct SliceSplitter
+		{
+			Searcher<typename std::remove_const<typename SliceElementType<T>::Ty>::type> separator;
+
+			bool next(Slice<T> &rest, bool &more, Slice<T> &token) const noexcept
+			{
+				if (!more)
+					return false;
+				size_t i = separator.find_first(rest);
+				token = rest.slice(0, i);
+				more = i < rest.length;
+				rest = rest.slice(more ? i + separator.needle().length : i, rest.length);
+				return true;
+			}
+		};
+		template <typename C>
+		struct LineSplitter
+		{
+			bool next(Slice<C> &rest, bool &, Slice<C> &token) const noexcept
+			{
+				if (rest.empty())
+					return false;
+				size_t i = rest.find_first('\n');
+				token = rest.slice(0, i);
+				if (token.length && token.back() == '\r')
+					--token.length;
+				rest = rest.slice(i < rest.length ? i + 1 : i, rest.length);
+				return true;
+			}
+		};
+	}
+
+	template <typename T, typename Splitter>
+	inline typename TokenRange<T, Splitter>::iterator& TokenRange<T, Splitter>::iterator::operator++() noexcept
+	{
+		done = !splitter->next(rest, more, token);
+		if (done)
+			token = nullptr;
+		return *this;
+	}
+	template <typename T, typename Splitter>
+	inline typename TokenRange<T, Splitter>::iterator TokenRange<T, Splitter>::begin() const noexcept
+	{
+		iterator it;
+		it.splitter = &splitter;
+		it.rest = source;
+		it.more = true;
+		it.done = false;
+		return ++it;
+	}
+	template <typename T, typename Splitter>
+	inline typename TokenRange<T, Splitter>::iterator TokenRange<T, Splitter>::end() const noexcept
+	{
+		iterator it;
+		it.splitter = &splitter;
+		it.more = false;
+		it.done = true;
+		return it;
+	}
+
+	template <typename T, bool S>
+	inline TokenRange<T, detail::TokenSplitter<T>> Slice<T, S>::tokens(Slice<const T> delimiters) const noexcept
+	{
+		return tokens(DelimiterSet<typename std::remove_const<value_type>::type>(delimiters));
+	}
+	template <typename T, bool S>
+	inline TokenRange<T, detail::TokenSplitter<T>> Slice<T, S>::tokens(const DelimiterSet<typename std::remove_const<value_type>::type> &delimiters) const noexcept
+	{
+		return TokenRange<T, detail::TokenSplitter<T>>(*this, detail::TokenSplitter<T>{ delimiters });
+	}
+	template <typename T, bool S>
+	inline TokenRange<T, detail::ElementSplitter<T>> Slice<T, S>::split(const_reference separator) const noexcept
+	{
+		return TokenRange<T, detail::ElementSplitter<T>>(*this, detail::ElementSplitter<T>{ separator });
+	}
+	template <typename T, bool S>
+	inline TokenRange<T, detail::SliceSplitter<T>> Slice<T, S>::split(Slice<const T> separator) const noexcept
+	{
+		SLICE_ASSERT(separator.length > 0);
+		return TokenRange<T, detail::SliceSplitter<T>>(*this, detail::SliceSplitter<T>{ separator });
+	}
+
+	namespace detail
+	{
+		template <typename C>
+		inline size_t strlen(const C *c_str) noexcept
+		{
+			size_t len = 0;
+			while (c_str[len])
+				++len;
+			return len;
+		}
+		template <> inline size_t strlen<char>(const char *c_str) noexcept { return ::strlen(c_str); }
+		template <> inline size_t strlen<unsigned char>(const unsigned char *c_str) noexcept { return ::strlen((char*)c_str); }
+		template <> inline size_t strlen<wchar_t>(const wchar_t *c_str) noexcept { return wcslen(c_str); }
+
+		template<typename C>
+		constexpr size_t utf_seq_length(char32_t c) noexcept;
+		template<> constexpr size_t utf_seq_length<char>(char32_t c) noexcept { return c < 0x80 ? 1 : (c < 0x800 ? 2 : (c < 0x10000 ? 3 : 4)); }
+		template<> constexpr size_t utf_seq_length<unsigned char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
+		template<> constexpr size_t utf_seq_length<const char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
+		template<> constexpr size_t utf_seq_length<const unsigned char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
+		template<> constexpr size_t utf_seq_length<char16_t>(char32_t c) noexcept { return c < 0x10000 ? 1 : 2; }
+		template<> constexpr size_t utf_seq_length<const char16_t>(char32_t c) noexcept { return c < 0x10000 ? 1 : 2; }
+		template<> constexpr size_t utf_seq_length<char32_t>(char32_t) noexcept { return 1; }
+		template<> constexpr size_t utf_seq_length<const char32_t>(char32_t c) noexcept { return 1; }
+		template<>
+		constexpr size_t utf_seq_length<wchar_t>(char32_t c) noexcept
+		{
+			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
+			return sizeof(wchar_t) == sizeof(char16_t) ? (c < 0x10000 ? 1 : 2) : 1;
+		}
+		template<> constexpr size_t utf_seq_length<const wchar_t>(char32_t c) noexcept { return utf_seq_length<wchar_t>(c); }
+
+		inline size_t utf_encode(char32_t c, char *utf8) noexcept
+		{
+			if (c < 0x80)
+			{
+				utf8[0] = (char)c;
+				return 1;
+			}
+			else if (c < 0x800)
+			{
+				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[0] = (c & 0x1f) | 0xc0;
+				return 2;
+			}
+			else if (c < 0x10000)
+			{
+				utf8[2] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[0] = (c & 0x0f) | 0xe0;
+				return 3;
+			}
+			else // NOTE: unicode was restricted to 20 bits, so we will stop here. the upper bits of a char32_t are truncated.
+			{
+				utf8[3] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[2] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
+				utf8[0] = (c & 0x07) | 0xf0;
+				return 4;
+			}
+		}
+		inline size_t utf_encode(char32_t c, unsigned char *utf8) noexcept
+		{
+			return utf_encode(c, (char*)utf8);
+		}
+		inline size_t utf_encode(char32_t c, char16_t *utf16) noexcept
+		{
+			if (c < 0x10000)
+			{
+				utf16[0] = (char16_t)c;
+				return 1;
+			}
+			else
+			{
+				c -= 0x10000;
+				utf16[0] = (char16_t)(0xD800 | (c >> 10));
+				utf16[1] = (char16_t)(0xDC00 | (c & 0x3FF));
+				return 2;
+			}
+		}
+		inline size_t utf_encode(char32_t c, char32_t *utf32) noexcept
+		{
+			*utf32 = c;
+			return 1;
+		}
+		inline size_t utf_encode(char32_t c, wchar_t *wc) noexcept
+		{
+			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
+			if (sizeof(wchar_t) == sizeof(char16_t))
+				return utf_encode(c, (char16_t*)wc);
+			else
+			{
+				*wc = (wchar_t)c;
+				return 1;
+			}
+		}
+
+		inline size_t utf_decode(const char *utf8, char32_t *c) noexcept
+		{
+			if ((unsigned char)utf8[0] < 128)
+			{
+				*c = utf8[0];
+				return 1;
+			}
+			else if ((utf8[0] & 0xE0) == 0xC0)
+			{
+				*c = ((char32_t)(utf8[0] & 0x1F) << 6) | (utf8[1] & 0x3F);
+				return 2;
+			}
+			else if ((utf8[0] & 0xF0) == 0xE0)
+			{
+				*c = ((char32_t)(utf8[0] & 0x0F) << 12) | ((char32_t)(utf8[1] & 0x3F) << 6) | (utf8[2] & 0x3F);
+				return 3;
+			}
+			else
+			{
+				*c = ((char32_t)(utf8[0] & 0x07) << 18) | ((char32_t)(utf8[1] & 0x3F) << 12) | ((char32_t)(utf8[2] & 0x3F) << 6) | (utf8[3] & 0x3F);
+				return 4;
+			}
+		}
+		inline size_t utf_decode(const unsigned char *utf8, char32_t *c) noexcept
+		{
+			return utf_decode((const char*)utf8, c);
+		}
+		inline size_t utf_decode(const char16_t *utf16, char32_t *c) noexcept
+		{
+			if (utf16[0] >= 0xD800 && (utf16[0] & 0xFC00) == 0xD800)
+			{
+				*c = 0x10000 + (((char32_t)(utf16[0] & 0x3FF) << 10) | (utf16[1] & 0x3FF));
+				return 2;
+			}
+			else
+			{
+				*c = utf16[0];
+				return 1;
+			}
+		}
+		inline size_t utf_decode(const char32_t *utf32, char32_t *c) noexcept
+		{
+			*c = *utf32;
+			return 1;
+		}
+		inline size_t utf_decode(const wchar_t *wc, char32_t *c) noexcept
+		{
+			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
+			if (sizeof(wchar_t) == sizeof(char16_t))
+				return utf_decode((char16_t*)wc, c);
+			else
+			{
+				*c = (char32_t)*wc;
+				return 1;
+			}
+		}
+		// decodes the code point at str without reading past end; a sequence which is truncated by end decodes as U+FFFD,
+		// and consumes the rest of the input
+		template <typename C>
+		inline size_t utf_decode(const C *str, const C *end, char32_t *c) noexcept
+		{
+			if (end - str >= 4)
+				return utf_decode(str, c);
+			C units[4] = {};
+			for (ptrdiff_t i = 0; i < end - str; ++i)
+				units[i] = str[i];
+			size_t n = utf_decode((const C*)units, c);
+			if (n <= (size_t)(end - str))
+				return n;
+			*c = 0xFFFD;
+			return end - str;
+		}
+
+		// Validation finds the first code unit which is not part of a well-formed sequence; an ill-formed sequence
+		// is reported at its first code unit. utf-8 rejects overlong encodings, surrogates, code points above
+		// 0x10FFFF and truncated sequences, utf-16 rejects unpaired surrogates, and utf-32 rejects surrogates and
+		// code points above 0x10FFFF.
+		inline size_t validate_utf8_scalar(const unsigned char *s, size_t i, size_t n) noexcept
+		{
+			while (i < n)
+			{
+				if (n - i >= 8)
+				{
+					uint64_t w;
+					memcpy(&w, s + i, 8);
+					w &= 0x8080808080808080ull;
+					if (!w)
+					{
+						i += 8;
+						continue;
+					}
+					i += ctz64(w) >> 3;
+				}
+				unsigned char c = s[i];
+				if (c < 0x80)
+				{
+					++i;
+					continue;
+				}
+				size_t len;
+				unsigned char lo = 0x80, hi = 0xBF;
+				if (c >= 0xC2 && c <= 0xDF)
+					len = 2;
+				else if (c >= 0xE0 && c <= 0xEF)
+				{
+					len = 3;
+					if (c == 0xE0)
+						lo = 0xA0;
+					else if (c == 0xED)
+						hi = 0x9F;
+				}
+				else if (c >= 0xF0 && c <= 0xF4)
+				{
+					len = 4;
+					if (c == 0xF0)
+						lo = 0x90;
+					else if (c == 0xF4)
+						hi = 0x8F;
+				}
+				else
+					return i;
+				if (n - i < len || s[i + 1] < lo || s[i + 1] > hi)
+					return i;
+				for (size_t j = 2; j < len; ++j)
+				{
+					if ((s[i + j] & 0xC0) != 0x80)
+						return i;
+				}
+				i += len;
+			}
+			return n;
+		}
+		inline size_t validate_utf16_scalar(const char16_t *s, size_t i, size_t n) noexcept
 		{
-			if (!SkipEmptyTokens)
+			for (; i < n; ++i)
 			{
-				size_t tokStart = offset;
-				while (offset < length && !delimiters.contains(ptr[offset]))
-					++offset;
-				tokens[numTokens++] = slice(tokStart, offset);
-				++offset;
+				if ((s[i] & 0xF800) == 0xD800)
+				{
+					if (s[i] >= 0xDC00 || i + 1 == n || (s[i + 1] & 0xFC00) != 0xDC00)
+						return i;
+					++i;
+				}
 			}
-			else
+			return n;
+		}
+		inline size_t validate_utf32_scalar(const char32_t *s, size_t i, size_t n) noexcept
+		{
+			while (i < n && s[i] < 0x110000 && (s[i] & 0xFFFFF800) != 0xD800)
+				++i;
+			return i;
+		}
+
+#if defined(SLICE_SIMD_SSE2)
+		// utf-8 is validated with the lookup algorithm from "Validating UTF-8 In Less Than One Instruction Per Byte"
+		// (Keiser, Lemire); the high and low nibbles of each byte, and the high nibble of the byte after it, look up
+		// the set of errors that each is consistent with, and any error common to all 3 is real. Bytes that must be
+		// the 2nd or 3rd continuation of a longer sequence are checked separately against the lead 2 and 3 bytes back.
+		struct Utf8Errors
+		{
+			enum : uint8_t
 			{
-				while (offset < length && delimiters.contains(ptr[offset]))
-					++offset;
-				if (offset == length)
+				TooShort = 1 << 0,		// 11______ 0_______, or 11______ 11______
+				TooLong = 1 << 1,		// 0_______ 10______
+				Overlong3 = 1 << 2,		// 11100000 100_____
+				TooLarge = 1 << 3,		// 11110100 1001____, or 11110100 101_____, or 11110101+ 10______
+				Surrogate = 1 << 4,		// 11101101 101_____
+				Overlong2 = 1 << 5,		// 1100000_ 10______
+				TooLarge1000 = 1 << 6,	// 11110101+ 1000____
+				Overlong4 = 1 << 6,		// 11110000 1000____
+				TwoConts = 1 << 7,		// 10______ 10______
+				Carry = TooShort | TooLong | TwoConts
+			};
+		};
+
+		template <typename Vec>
+		inline typename Vec::V simd_utf8_errors(typename Vec::V input, typename Vec::V last, const typename Vec::V tables[3]) noexcept
+		{
+			using E = Utf8Errors;
+			const typename Vec::V nibble = Vec::template splat<1>(0x0F);
+			typename Vec::V prev1 = Vec::template prev<1>(input, last);
+			typename Vec::V special = Vec::vand(Vec::vand(Vec::shuffle(tables[0], Vec::vand(Vec::srli4(prev1), nibble)),
+														  Vec::shuffle(tables[1], Vec::vand(prev1, nibble))),
+												Vec::shuffle(tables[2], Vec::vand(Vec::srli4(input), nibble)));
+			// the top bit is set where the byte 2 back is >= 0xE0, or the byte 3 back is >= 0xF0
+			typename Vec::V must23 = Vec::vor(Vec::subs_u8(Vec::template prev<2>(input, last), Vec::template splat<1>(0xE0 - 0x80)),
+											  Vec::subs_u8(Vec::template prev<3>(input, last), Vec::template splat<1>(0xF0 - 0x80)));
+			return Vec::vxor(Vec::vand(must23, Vec::template splat<1>(E::TwoConts)), special);
+		}
+
+		template <typename Vec>
+		inline size_t simd_validate_utf8(const char *p, size_t n) noexcept
+		{
+			using E = Utf8Errors;
+			alignas(16) static const uint8_t tables[3][16] = {
+				// high nibble of the first byte
+				{ E::TooLong, E::TooLong, E::TooLong, E::TooLong, E::TooLong, E::TooLong, E::TooLong, E::TooLong,
+				  E::TwoConts, E::TwoConts, E::TwoConts, E::TwoConts,
+				  E::TooShort | E::Overlong2,
+				  E::TooShort,
+				  E::TooShort | E::Overlong3 | E::Surrogate,
+				  E::TooShort | E::TooLarge | E::TooLarge1000 | E::Overlong4 },
+				// low nibble of the first byte
+				{ E::Carry | E::Overlong3 | E::Overlong2 | E::Overlong4,
+				  E::Carry | E::Overlong2,
+				  E::Carry,
+				  E::Carry,
+				  E::Carry | E::TooLarge,
+				  E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000,
+				  E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000,
+				  E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000,
+				  E::Carry | E::TooLarge | E::TooLarge1000 | E::Surrogate,
+				  E::Carry | E::TooLarge | E::TooLarge1000, E::Carry | E::TooLarge | E::TooLarge1000 },
+				// high nibble of the second byte
+				{ E::TooShort, E::TooShort, E::TooShort, E::TooShort, E::TooShort, E::TooShort, E::TooShort, E::TooShort,
+				  E::TooLong | E::Overlong2 | E::TwoConts | E::Overlong3 | E::TooLarge1000 | E::Overlong4,
+				  E::TooLong | E::Overlong2 | E::TwoConts | E::Overlong3 | E::TooLarge,
+				  E::TooLong | E::Overlong2 | E::TwoConts | E::Surrogate | E::TooLarge,
+				  E::TooLong | E::Overlong2 | E::TwoConts | E::Surrogate | E::TooLarge,
+				  E::TooShort, E::TooShort, E::TooShort, E::TooShort }
+			};
+			// a block which ends within the first 1, 2 or 3 bytes of a longer sequence must be followed by continuations
+			static const uint8_t incomplete[64] = {
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+			};
+			const typename Vec::V lookup[3] = { Vec::broadcast16(tables[0]), Vec::broadcast16(tables[1]), Vec::broadcast16(tables[2]) };
+			const typename Vec::V maxValue = Vec::load(incomplete + 64 - Vec::Width);
+			typename Vec::V last = Vec::zero(), lastIncomplete = Vec::zero();
+
+			// stop at the first block with an error; the scalar validator will locate it
+			size_t i = 0;
+			for (; i + Vec::Width <= n; i += Vec::Width)
+			{
+				typename Vec::V input = Vec::load(p + i);
+				typename Vec::V error;
+				if (!Vec::sign_bits(input))
+				{
+					error = lastIncomplete;
+					lastIncomplete = Vec::zero();
+				}
+				else
+				{
+					error = simd_utf8_errors<Vec>(input, last, lookup);
+					lastIncomplete = Vec::subs_u8(input, maxValue);
+				}
+				if (Vec::template mask<1>(Vec::template cmpeq<1>(error, Vec::zero())) != simd_lane_mask<Vec, 1>())
 					break;
-				size_t tokStart = offset;
-				while (offset < length && !delimiters.contains(ptr[offset]))
-					++offset;
-				tokens[numTokens++] = slice(tokStart, offset);
+				last = input;
 			}
+
+			// resume from the start of the sequence which spans the start of the block
+			size_t start = i;
+			while (start > 0 && i - start < 3 && (p[start - 1] & 0xC0) == 0x80)
+				--start;
+			if (start > 0 && (unsigned char)p[start - 1] >= 0xC0)
+				--start;
+			return validate_utf8_scalar((const unsigned char*)p, start, n);
 		}
-		if (!SkipEmptyTokens && offset > length)
-			offset = length;
-		ptr += offset;
-		length -= offset;
-		return tokens.front(numTokens);
-	}
-	template <typename T, bool S>
-	template <bool SkipEmptyTokens>
-	inline size_t Slice<T, S>::tokenise(std::function<void(Slice<T> token, size_t index)> onToken, Slice<const T> delimiters) const noexcept
-	{
-		size_t numTokens = 0;
-		size_t offset = 0;
-		while (offset < length)
+
+		template <typename Vec>
+		inline size_t simd_validate_utf16(const char16_t *p, size_t n) noexcept
 		{
-			if (!SkipEmptyTokens)
+			enum { Lanes = Vec::Width / 2 };
+			const size_t b = Vec::bits(2);
+			const uint64_t all = simd_lane_mask<Vec, 2>();
+			uint64_t carry = 0;
+			size_t i = 0;
+			for (; i + Lanes <= n; i += Lanes)
 			{
-				size_t tokStart = offset;
-				while (offset < length && !delimiters.contains(ptr[offset]))
-					++offset;
-				onToken(slice(tokStart, offset++), numTokens++);
+				typename Vec::V v = Vec::load(p + i);
+				uint64_t hi = Vec::template mask<2>(Vec::template in_range<2>(v, 0xD800, 0x400));
+				uint64_t lo = Vec::template mask<2>(Vec::template in_range<2>(v, 0xDC00, 0x400));
+				if (!(hi | lo | carry))
+					continue;
+				// every high surrogate must be followed by a low surrogate, and every low surrogate preceded by a high one
+				uint64_t expected = ((hi << b) | carry) & all;
+				uint64_t bad = expected ^ lo;
+				if (bad)
+				{
+					size_t k = ctz64(bad) / b;
+					return (expected >> (k*b)) & 1 ? i + k - 1 : i + k;
+				}
+				carry = hi >> ((Lanes - 1)*b);
 			}
-			else
+			return validate_utf16_scalar(p, carry ? i - 1 : i, n);
+		}
+
+		template <typename Vec>
+		struct SimdUtf32Invalid
+		{
+			uint64_t match(const char *p) const noexcept
 			{
-				while (offset < length && delimiters.contains(ptr[offset]))
-					++offset;
-				if (offset == length)
+				typename Vec::V v = Vec::load(p);
+				return Vec::template mask<4>(Vec::mor(Vec::template in_range<4>(v, 0xD800, 0x800), Vec::template in_range<4>(v, 0x110000, 0xFFEF0000)));
+			}
+		};
+#endif
+
+		inline size_t validate_utf8(const char *s, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width)
+				return simd_validate_utf8<Simd512>(s, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width)
+				return simd_validate_utf8<Simd256>(s, n);
+#endif
+#if defined(SLICE_SIMD_SSSE3)
+			if (n >= Simd128::Width)
+				return simd_validate_utf8<Simd128>(s, n);
+#endif
+			return validate_utf8_scalar((const unsigned char*)s, 0, n);
+		}
+		inline size_t validate_utf16(const char16_t *s, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / 2)
+				return simd_validate_utf16<Simd512>(s, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / 2)
+				return simd_validate_utf16<Simd256>(s, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / 2)
+				return simd_validate_utf16<Simd128>(s, n);
+#endif
+			return validate_utf16_scalar(s, 0, n);
+		}
+		inline size_t validate_utf32(const char32_t *s, size_t n) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / 4)
+				return simd_find_match<Simd512, 4, true>((const char*)s, n, SimdUtf32Invalid<Simd512>());
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / 4)
+				return simd_find_match<Simd256, 4, true>((const char*)s, n, SimdUtf32Invalid<Simd256>());
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / 4)
+				return simd_find_match<Simd128, 4, true>((const char*)s, n, SimdUtf32Invalid<Simd128>());
+#endif
+			return validate_utf32_scalar(s, 0, n);
+		}
+		inline size_t validate_utf(const char *s, size_t n) noexcept { return validate_utf8(s, n); }
+		inline size_t validate_utf(const unsigned char *s, size_t n) noexcept { return validate_utf8((const char*)s, n); }
+		inline size_t validate_utf(const char16_t *s, size_t n) noexcept { return validate_utf16(s, n); }
+		inline size_t validate_utf(const char32_t *s, size_t n) noexcept { return validate_utf32(s, n); }
+		inline size_t validate_utf(const wchar_t *s, size_t n) noexcept
+		{
+			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
+			if (sizeof(wchar_t) == sizeof(char16_t))
+				return validate_utf16((const char16_t*)s, n);
+			return validate_utf32((const char32_t*)s, n);
+		}
+
+		// Characters are counted and indexed by the code units that begin them, which are those that aren't utf-8
+		// continuation bytes or utf-16 low surrogates. This agrees with decoding for well-formed strings.
+		inline bool is_utf_lead(char c) noexcept { return (c & 0xC0) != 0x80; }
+		inline bool is_utf_lead(char16_t c) noexcept { return (c & 0xFC00) != 0xDC00; }
+
+		// counts the continuation bytes in 8 bytes of utf-8
+		inline size_t utf8_count_continuations(const char *s) noexcept
+		{
+			uint64_t w;
+			memcpy(&w, s, 8);
+			return popcount64(w & ~(w << 1) & 0x8080808080808080ull);
+		}
+
+		inline size_t num_chars_scalar(const char *s, size_t i, size_t n) noexcept
+		{
+			size_t count = n - i;
+			for (; n - i >= 8; i += 8)
+				count -= utf8_count_continuations(s + i);
+			for (; i < n; ++i)
+				count -= !is_utf_lead(s[i]);
+			return count;
+		}
+		inline size_t num_chars_scalar(const char16_t *s, size_t i, size_t n) noexcept
+		{
+			size_t count = n - i;
+			for (; i < n; ++i)
+				count -= !is_utf_lead(s[i]);
+			return count;
+		}
+		inline size_t char_offset_scalar(const char *s, size_t i, size_t n, size_t index) noexcept
+		{
+			for (; n - i >= 8; i += 8)
+			{
+				size_t count = 8 - utf8_count_continuations(s + i);
+				if (index < count)
 					break;
-				size_t tokStart = offset;
-				while (offset < length && !delimiters.contains(ptr[offset]))
-					++offset;
-				onToken(slice(tokStart, offset), numTokens++);
+				index -= count;
+			}
+			for (; i < n; ++i)
+			{
+				if (is_utf_lead(s[i]) && index-- == 0)
+					return i;
 			}
+			return n;
+		}
+		inline size_t char_offset_scalar(const char16_t *s, size_t i, size_t n, size_t index) noexcept
+		{
+			for (; i < n; ++i)
+			{
+				if (is_utf_lead(s[i]) && index-- == 0)
+					return i;
+			}
+			return n;
 		}
-		return numTokens;
-	}
 
-	namespace detail
-	{
-		// TODO: these are pretty lame! use lookup table? (requires .cpp file)
-		constexpr bool is_whitespace(char32_t c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
-		constexpr bool is_hex(char32_t c) noexcept { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
-		constexpr bool is_number(char32_t c) noexcept { return c >= '0' && c <= '9'; }
+#if defined(SLICE_SIMD_SSE2)
+		template <typename Vec>
+		inline uint64_t simd_utf_leads(const char *p) noexcept
+		{
+			return ~Vec::template mask<1>(Vec::template in_range<1>(Vec::load(p), 0x80, 0x40)) & simd_lane_mask<Vec, 1>();
+		}
+		template <typename Vec>
+		inline uint64_t simd_utf_leads(const char16_t *p) noexcept
+		{
+			return ~Vec::template mask<2>(Vec::template in_range<2>(Vec::load(p), 0xDC00, 0x400)) & simd_lane_mask<Vec, 2>();
+		}
 
-		constexpr char32_t to_lower(char32_t c) noexcept { return c >= 'A' && c <= 'Z' ? c | 0x20 : c; }
-		constexpr char32_t to_upper(char32_t c) noexcept { return c >= 'a' && c <= 'z' ? c & ~0x20 : c; }
+		template <typename Vec, typename C>
+		inline size_t simd_num_chars(const C *s, size_t n) noexcept
+		{
+			enum { Lanes = Vec::Width / sizeof(C) };
+			size_t bits = 0, i = 0;
+			for (; i + Lanes <= n; i += Lanes)
+				bits += popcount64(simd_utf_leads<Vec>(s + i));
+			return bits / Vec::bits(sizeof(C)) + num_chars_scalar(s, i, n);
+		}
+		template <typename Vec, typename C>
+		inline size_t simd_char_offset(const C *s, size_t n, size_t index) noexcept
+		{
+			enum { Lanes = Vec::Width / sizeof(C) };
+			const size_t b = Vec::bits(sizeof(C));
+			size_t i = 0;
+			for (; i + Lanes <= n; i += Lanes)
+			{
+				uint64_t leads = simd_utf_leads<Vec>(s + i);
+				size_t count = popcount64(leads) / b;
+				if (index < count)
+				{
+					// drop the leads before the one we want
+					for (size_t k = index*b; k; --k)
+						leads &= leads - 1;
+					return i + ctz64(leads) / b;
+				}
+				index -= count;
+			}
+			return char_offset_scalar(s, i, n, index);
+		}
+#endif
 
 		template <typename C>
-		inline size_t strlen(const C *c_str) noexcept
+		inline size_t num_utf_chars(const C *s, size_t n) noexcept
 		{
-			size_t len = 0;
-			while (c_str[len])
-				++len;
-			return len;
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(C))
+				return simd_num_chars<Simd512>(s, n);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(C))
+				return simd_num_chars<Simd256>(s, n);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(C))
+				return simd_num_chars<Simd128>(s, n);
+#endif
+			return num_chars_scalar(s, 0, n);
+		}
+		template <typename C>
+		inline size_t utf_char_offset(const C *s, size_t n, size_t index) noexcept
+		{
+			if (index >= n)
+				return n;
+#if defined(SLICE_SIMD_AVX512)
+			if (n >= Simd512::Width / sizeof(C))
+				return simd_char_offset<Simd512>(s, n, index);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (n >= Simd256::Width / sizeof(C))
+				return simd_char_offset<Simd256>(s, n, index);
+#endif
+#if defined(SLICE_SIMD_SSE2)
+			if (n >= Simd128::Width / sizeof(C))
+				return simd_char_offset<Simd128>(s, n, index);
+#endif
+			return char_offset_scalar(s, 0, n, index);
 		}
-		template <> inline size_t strlen<char>(const char *c_str) noexcept { return ::strlen(c_str); }
-		template <> inline size_t strlen<unsigned char>(const unsigned char *c_str) noexcept { return ::strlen((char*)c_str); }
-		template <> inline size_t strlen<wchar_t>(const wchar_t *c_str) noexcept { return wcslen(c_str); }
 
-		template<typename C>
-		constexpr size_t utf_seq_length(char32_t c) noexcept;
-		template<> constexpr size_t utf_seq_length<char>(char32_t c) noexcept { return c < 0x80 ? 1 : (c < 0x800 ? 2 : (c < 0x10000 ? 3 : 4)); }
-		template<> constexpr size_t utf_seq_length<unsigned char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
-		template<> constexpr size_t utf_seq_length<const char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
-		template<> constexpr size_t utf_seq_length<const unsigned char>(char32_t c) noexcept { return utf_seq_length<char>(c); }
-		template<> constexpr size_t utf_seq_length<char16_t>(char32_t c) noexcept { return c < 0x10000 ? 1 : 2; }
-		template<> constexpr size_t utf_seq_length<const char16_t>(char32_t c) noexcept { return c < 0x10000 ? 1 : 2; }
-		template<> constexpr size_t utf_seq_length<char32_t>(char32_t) noexcept { return 1; }
-		template<> constexpr size_t utf_seq_length<const char32_t>(char32_t c) noexcept { return 1; }
-		template<>
-		constexpr size_t utf_seq_length<wchar_t>(char32_t c) noexcept
+		inline size_t num_chars(const char *s, size_t n) noexcept { return num_utf_chars(s, n); }
+		inline size_t num_chars(const unsigned char *s, size_t n) noexcept { return num_utf_chars((const char*)s, n); }
+		inline size_t num_chars(const char16_t *s, size_t n) noexcept { return num_utf_chars(s, n); }
+		inline size_t num_chars(const char32_t *, size_t n) noexcept { return n; }
+		inline size_t num_chars(const wchar_t *s, size_t n) noexcept
 		{
 			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
-			return sizeof(wchar_t) == sizeof(char16_t) ? (c < 0x10000 ? 1 : 2) : 1;
+			return sizeof(wchar_t) == sizeof(char16_t) ? num_utf_chars((const char16_t*)s, n) : n;
+		}
+		inline size_t char_offset(const char *s, size_t n, size_t index) noexcept { return utf_char_offset(s, n, index); }
+		inline size_t char_offset(const unsigned char *s, size_t n, size_t index) noexcept { return utf_char_offset((const char*)s, n, index); }
+		inline size_t char_offset(const char16_t *s, size_t n, size_t index) noexcept { return utf_char_offset(s, n, index); }
+		inline size_t char_offset(const char32_t *, size_t n, size_t index) noexcept { return index < n ? index : n; }
+		inline size_t char_offset(const wchar_t *s, size_t n, size_t index) noexcept
+		{
+			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
+			if (sizeof(wchar_t) == sizeof(char16_t))
+				return utf_char_offset((const char16_t*)s, n, index);
+			return index < n ? index : n;
 		}
-		template<> constexpr size_t utf_seq_length<const wchar_t>(char32_t c) noexcept { return utf_seq_length<wchar_t>(c); }
 
-		inline size_t utf_encode(char32_t c, char *utf8) noexcept
+		// Transcoding kernels convert whole blocks of a string while there is room for a block in the output, and
+		// advance `in` past what they consumed, leaving the remainder to the scalar loops. Any block they don't handle
+		// (4 byte utf-8 sequences, utf-16 surrogates, and anything ill-formed) is converted one code point at a time,
+		// so the result is always the same as decoding and encoding each code point. The count kernels likewise count
+		// the code units that a prefix of the input would transcode to.
+#if defined(SLICE_SIMD_SSE2)
+		inline __m128i simd_select(__m128i mask, __m128i a, __m128i b) noexcept
 		{
-			if (c < 0x80)
+			return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+		}
+		inline bool simd_all_zero(__m128i v) noexcept
+		{
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+		}
+
+		// utf-8 is decoded in 16 byte windows; the characters which begin in the first 14 bytes are decoded when they
+		// are all 1-3 bytes long, and the lead bytes and continuation bytes are where one another expect them to be
+		struct Utf8Window
+		{
+			unsigned leads;		// lead bytes of the characters decoded
+			unsigned length;	// bytes consumed, up to the next lead byte
+
+			bool classify(__m128i v) noexcept
 			{
-				utf8[0] = (char)c;
-				return 1;
+				unsigned high = (unsigned)_mm_movemask_epi8(v);
+				unsigned cont = (unsigned)_mm_movemask_epi8(_mm_cmplt_epi8(v, _mm_set1_epi8((char)0xC0)));
+				unsigned lead3 = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)0xDF))) & high;
+				unsigned lead4 = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)0xEF))) & high;
+				unsigned lead2 = high & ~cont & ~lead3;
+				leads = ~cont & 0x3FFF;
+				length = ctz64((~cont & 0xC000) | 0x10000);
+				unsigned expected = ((lead2 | lead3) & 0x3FFF) << 1 | (lead3 & 0x3FFF) << 2;
+				return !lead4 && (cont & ((1u << length) - 1)) == expected;
 			}
-			else if (c < 0x800)
+		};
+
+		template <typename T, typename C>
+		inline T* utf_transcode_scalar(T *out, const C *&in, const C *until) noexcept
+		{
+			while (in < until)
 			{
-				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[0] = (c & 0x1f) | 0xc0;
-				return 2;
+				char32_t c;
+				in += utf_decode(in, &c);
+				out += utf_encode(c, out);
 			}
-			else if (c < 0x10000)
+			return out;
+		}
+		template <typename T, typename C>
+		inline size_t utf_count_scalar(const C *&in, const C *until) noexcept
+		{
+			size_t count = 0;
+			while (in < until)
 			{
-				utf8[2] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[0] = (c & 0x0f) | 0xe0;
-				return 3;
+				char32_t c;
+				in += utf_decode(in, &c);
+				count += utf_seq_length<T>(c);
 			}
-			else // NOTE: unicode was restricted to 20 bits, so we will stop here. the upper bits of a char32_t are truncated.
+			return count;
+		}
+
+		template <typename T>
+		inline size_t simd_utf8_decode_count(const char *&in, const char *end) noexcept
+		{
+			size_t count = 0;
+			const char *p = in;
+			while (end - p >= 32)
 			{
-				utf8[3] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[2] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[1] = (c & 0x3f) | 0x80; c >>= 6;
-				utf8[0] = (c & 0x07) | 0xf0;
-				return 4;
+				__m128i v = _mm_loadu_si128((const __m128i*)p);
+				Utf8Window w;
+				if (!_mm_movemask_epi8(v))
+				{
+					count += 16;
+					p += 16;
+				}
+				else if (w.classify(v))
+				{
+					count += popcount64(w.leads);
+					p += w.length;
+				}
+				else
+					count += utf_count_scalar<T>(p, p + 14);
 			}
+			in = p;
+			return count;
 		}
-		inline size_t utf_encode(char32_t c, unsigned char *utf8) noexcept
+
+		// counts the code units that utf-16 transcodes to; blocks with surrogates are counted when every surrogate is
+		// paired, and counting stops at any block that isn't
+		template <typename Vec, bool ToUtf8>
+		inline size_t simd_utf16_count(const char16_t *&in, const char16_t *end) noexcept
+		{
+			enum { Lanes = Vec::Width / 2 };
+			const size_t b = Vec::bits(2);
+			const uint64_t all = simd_lane_mask<Vec, 2>();
+			uint64_t carry = 0;
+			size_t count = 0;
+			const char16_t *p = in;
+			for (; end - p >= Lanes; p += Lanes)
+			{
+				typename Vec::V v = Vec::load(p);
+				uint64_t hi = Vec::template mask<2>(Vec::template in_range<2>(v, 0xD800, 0x400));
+				uint64_t lo = Vec::template mask<2>(Vec::template in_range<2>(v, 0xDC00, 0x400));
+				if ((((hi << b) | carry) & all) != lo)
+					break;
+				carry = hi >> ((Lanes - 1)*b);
+				if (ToUtf8)
+				{
+					// 3 bytes, less 1 for < 0x800, 1 more for < 0x80, and 1 for each half of a surrogate pair
+					unsigned small = popcount64(Vec::template mask<2>(Vec::template in_range<2>(v, 0, 0x800)));
+					unsigned ascii = popcount64(Vec::template mask<2>(Vec::template in_range<2>(v, 0, 0x80)));
+					count += Lanes*3 - (small + ascii + popcount64(hi | lo)) / b;
+				}
+				else
+					count += Lanes - popcount64(lo) / b;
+			}
+			if (carry)
+			{
+				// leave the high surrogate at the end of the last block for the scalar loop
+				--p;
+				count -= ToUtf8 ? 2 : 1;
+			}
+			in = p;
+			return count;
+		}
+		template <typename Vec, bool ToUtf8>
+		inline size_t simd_utf32_count(const char32_t *&in, const char32_t *end) noexcept
+		{
+			enum { Lanes = Vec::Width / 4 };
+			const size_t b = Vec::bits(4);
+			size_t count = 0;
+			for (; end - in >= Lanes; in += Lanes)
+			{
+				typename Vec::V v = Vec::load(in);
+				unsigned bmp = popcount64(Vec::template mask<4>(Vec::template in_range<4>(v, 0, 0x10000)));
+				if (ToUtf8)
+				{
+					unsigned small = popcount64(Vec::template mask<4>(Vec::template in_range<4>(v, 0, 0x800)));
+					unsigned ascii = popcount64(Vec::template mask<4>(Vec::template in_range<4>(v, 0, 0x80)));
+					count += Lanes*4 - (bmp + small + ascii) / b;
+				}
+				else
+					count += Lanes*2 - bmp / b;
+			}
+			return count;
+		}
+
+		template <bool ToUtf8>
+		inline size_t simd_utf16_count(const char16_t *&in, const char16_t *end) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (end - in >= Simd512::Width / 2)
+				return simd_utf16_count<Simd512, ToUtf8>(in, end);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (end - in >= Simd256::Width / 2)
+				return simd_utf16_count<Simd256, ToUtf8>(in, end);
+#endif
+			return simd_utf16_count<Simd128, ToUtf8>(in, end);
+		}
+		template <bool ToUtf8>
+		inline size_t simd_utf32_count(const char32_t *&in, const char32_t *end) noexcept
+		{
+#if defined(SLICE_SIMD_AVX512)
+			if (end - in >= Simd512::Width / 4)
+				return simd_utf32_count<Simd512, ToUtf8>(in, end);
+#endif
+#if defined(SLICE_SIMD_AVX2)
+			if (end - in >= Simd256::Width / 4)
+				return simd_utf32_count<Simd256, ToUtf8>(in, end);
+#endif
+			return simd_utf32_count<Simd128, ToUtf8>(in, end);
+		}
+
+		inline char32_t* simd_utf16_to_utf32(char32_t *out, char32_t *outEnd, const char16_t *&in, const char16_t *end) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			while (end - in >= 16 && outEnd - out >= 16)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)in);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800))))
+				{
+					out = utf_transcode_scalar(out, in, in + 8);
+					continue;
+				}
+				_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(v, zero));
+				_mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(v, zero));
+				out += 8;
+				in += 8;
+			}
+			return out;
+		}
+		inline char16_t* simd_utf32_to_utf16(char16_t *out, char16_t *outEnd, const char32_t *&in, const char32_t *end) noexcept
+		{
+			const __m128i bias = _mm_set1_epi32(0x8000);
+			while (end - in >= 8 && outEnd - out >= 16)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i*)in);
+				__m128i b = _mm_loadu_si128((const __m128i*)(in + 4));
+				if (!simd_all_zero(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi32((int)0xFFFF0000))))
+				{
+					out = utf_transcode_scalar(out, in, in + 8);
+					continue;
+				}
+				// pack with signed saturation, biased so that 16 bit values don't saturate
+				__m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+				_mm_storeu_si128((__m128i*)out, _mm_add_epi16(packed, _mm_set1_epi16((short)0x8000)));
+				out += 8;
+				in += 8;
+			}
+			return out;
+		}
+
+#if defined(SLICE_SIMD_SSSE3)
+		// shuffles which gather the 16bit lanes selected by an 8 bit mask to the front of a vector, and the number of lanes
+		struct Utf16Compress
+		{
+			uint8_t shuffle[256][16];
+			uint8_t count[256];
+
+			constexpr Utf16Compress() noexcept
+				: shuffle(), count()
+			{
+				for (unsigned m = 0; m < 256; ++m)
+				{
+					unsigned n = 0;
+					for (unsigned k = 0; k < 8; ++k)
+					{
+						if (m & (1 << k))
+						{
+							shuffle[m][n*2] = (uint8_t)(k*2);
+							shuffle[m][n*2 + 1] = (uint8_t)(k*2 + 1);
+							++n;
+						}
+					}
+					count[m] = (uint8_t)n;
+					for (; n < 8; ++n)
+						shuffle[m][n*2] = shuffle[m][n*2 + 1] = 0x80;
+				}
+			}
+		};
+		// shuffles which gather the utf-8 bytes of 4 code points from their 32bit lanes; the index holds the length of
+		// each less one, in 2 bits per lane
+		struct Utf8Compress
+		{
+			uint8_t shuffle[256][16];
+			uint8_t length[256];
+
+			constexpr Utf8Compress() noexcept
+				: shuffle(), length()
+			{
+				for (unsigned i = 0; i < 256; ++i)
+				{
+					unsigned n = 0;
+					for (unsigned k = 0; k < 4; ++k)
+					{
+						for (unsigned j = 0; j <= ((i >> k*2) & 3) && j < 3; ++j)
+							shuffle[i][n++] = (uint8_t)(k*4 + j);
+					}
+					length[i] = (uint8_t)n;
+					for (; n < 16; ++n)
+						shuffle[i][n] = 0x80;
+				}
+			}
+		};
+
+		// decodes 8 lanes of the code points which start at each byte; b0, b1 and b2 are the bytes at, and following,
+		// each lane
+		inline __m128i utf8_decode8(__m128i b0, __m128i b1, __m128i b2) noexcept
 		{
-			return utf_encode(c, (char*)utf8);
+			const __m128i m3F = _mm_set1_epi16(0x3F);
+			__m128i t1 = _mm_and_si128(b1, m3F);
+			__m128i c2 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(0x1F)), 6), t1);
+			__m128i c3 = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(b0, 12), _mm_slli_epi16(t1, 6)), _mm_and_si128(b2, m3F));
+			__m128i r = simd_select(_mm_cmpgt_epi16(b0, _mm_set1_epi16(0xBF)), c2, b0);
+			return simd_select(_mm_cmpgt_epi16(b0, _mm_set1_epi16(0xDF)), c3, r);
 		}
-		inline size_t utf_encode(char32_t c, char16_t *utf16) noexcept
+		inline void utf8_decode_store(char16_t *out, __m128i cp) noexcept
 		{
-			if (c < 0x10000)
-			{
-				utf16[0] = (char16_t)c;
-				return 1;
-			}
-			else
-			{
-				c -= 0x10000;
-				utf16[0] = (char16_t)(0xD800 | (c >> 10));
-				utf16[1] = (char16_t)(0xDC00 | (c & 0x3FF));
-				return 2;
-			}
+			_mm_storeu_si128((__m128i*)out, cp);
 		}
-		inline size_t utf_encode(char32_t c, char32_t *utf32) noexcept
+		inline void utf8_decode_store(char32_t *out, __m128i cp) noexcept
 		{
-			*utf32 = c;
-			return 1;
+			_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(cp, _mm_setzero_si128()));
+			_mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(cp, _mm_setzero_si128()));
 		}
-		inline size_t utf_encode(char32_t c, wchar_t *wc) noexcept
+
+		template <typename T>
+		inline T* simd_utf8_decode(T *out, T *outEnd, const char *&in, const char *end) noexcept
 		{
-			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
-			if (sizeof(wchar_t) == sizeof(char16_t))
-				return utf_encode(c, (char16_t*)wc);
-			else
+			static constexpr Utf16Compress compress = Utf16Compress();
+			const __m128i zero = _mm_setzero_si128();
+			const char *p = in;
+			while (end - p >= 32 && outEnd - out >= 32)
 			{
-				*wc = (wchar_t)c;
-				return 1;
+				__m128i v = _mm_loadu_si128((const __m128i*)p);
+				Utf8Window w;
+				if (!_mm_movemask_epi8(v))
+				{
+					utf8_decode_store(out, _mm_unpacklo_epi8(v, zero));
+					utf8_decode_store(out + 8, _mm_unpackhi_epi8(v, zero));
+					out += 16;
+					p += 16;
+				}
+				else if (w.classify(v))
+				{
+					__m128i v1 = _mm_srli_si128(v, 1), v2 = _mm_srli_si128(v, 2);
+					__m128i lo = utf8_decode8(_mm_unpacklo_epi8(v, zero), _mm_unpacklo_epi8(v1, zero), _mm_unpacklo_epi8(v2, zero));
+					__m128i hi = utf8_decode8(_mm_unpackhi_epi8(v, zero), _mm_unpackhi_epi8(v1, zero), _mm_unpackhi_epi8(v2, zero));
+					unsigned loLeads = w.leads & 0xFF, hiLeads = w.leads >> 8;
+					utf8_decode_store(out, _mm_shuffle_epi8(lo, _mm_loadu_si128((const __m128i*)compress.shuffle[loLeads])));
+					out += compress.count[loLeads];
+					utf8_decode_store(out, _mm_shuffle_epi8(hi, _mm_loadu_si128((const __m128i*)compress.shuffle[hiLeads])));
+					out += compress.count[hiLeads];
+					p += w.length;
+				}
+				else
+					out = utf_transcode_scalar(out, p, p + 14);
 			}
+			in = p;
+			return out;
 		}
 
-		inline size_t utf_decode(const char *utf8, char32_t *c) noexcept
+		// encodes 4 code points < 0x10000 as utf-8
+		inline char* utf8_encode4(char *out, __m128i cp) noexcept
 		{
-			if ((unsigned char)utf8[0] < 128)
-			{
-				*c = utf8[0];
-				return 1;
-			}
-			else if ((utf8[0] & 0xE0) == 0xC0)
-			{
-				*c = ((char32_t)(utf8[0] & 0x1F) << 6) | (utf8[1] & 0x3F);
-				return 2;
-			}
-			else if ((utf8[0] & 0xF0) == 0xE0)
+			static constexpr Utf8Compress compress = Utf8Compress();
+			const __m128i m3F = _mm_set1_epi32(0x3F), m80 = _mm_set1_epi32(0x80);
+			__m128i two = _mm_cmpgt_epi32(cp, _mm_set1_epi32(0x7F));
+			__m128i three = _mm_cmpgt_epi32(cp, _mm_set1_epi32(0x7FF));
+			__m128i low = _mm_or_si128(_mm_and_si128(cp, m3F), m80);
+			__m128i mid = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(cp, 6), m3F), m80);
+			__m128i w2 = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(cp, 6), _mm_set1_epi32(0xC0)), _mm_slli_epi32(low, 8));
+			__m128i w3 = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(cp, 12), _mm_set1_epi32(0xE0)), _mm_or_si128(_mm_slli_epi32(mid, 8), _mm_slli_epi32(low, 16)));
+			__m128i bytes = simd_select(three, w3, simd_select(two, w2, cp));
+			// spread the lane masks to 2 bits per lane, and sum them for the length of each less one
+			unsigned t2 = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(two)), t3 = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(three));
+			t2 = (t2 & 1) | (t2 & 2) << 1 | (t2 & 4) << 2 | (t2 & 8) << 3;
+			t3 = (t3 & 1) | (t3 & 2) << 1 | (t3 & 4) << 2 | (t3 & 8) << 3;
+			unsigned index = t2 + t3;
+			_mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(bytes, _mm_loadu_si128((const __m128i*)compress.shuffle[index])));
+			return out + compress.length[index];
+		}
+
+		inline char* simd_utf8_encode(char *out, char *outEnd, const char16_t *&in, const char16_t *end) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			while (end - in >= 16 && outEnd - out >= 32)
 			{
-				*c = ((char32_t)(utf8[0] & 0x0F) << 12) | ((char32_t)(utf8[1] & 0x3F) << 6) | (utf8[2] & 0x3F);
-				return 3;
+				__m128i a = _mm_loadu_si128((const __m128i*)in);
+				__m128i b = _mm_loadu_si128((const __m128i*)(in + 8));
+				if (simd_all_zero(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16((short)0xFF80))))
+				{
+					_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(a, b));
+					out += 16;
+					in += 16;
+					continue;
+				}
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(a, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800))))
+				{
+					out = utf_transcode_scalar(out, in, in + 8);
+					continue;
+				}
+				out = utf8_encode4(out, _mm_unpacklo_epi16(a, zero));
+				out = utf8_encode4(out, _mm_unpackhi_epi16(a, zero));
+				in += 8;
 			}
-			else
+			return out;
+		}
+		inline char* simd_utf8_encode(char *out, char *outEnd, const char32_t *&in, const char32_t *end) noexcept
+		{
+			while (end - in >= 8 && outEnd - out >= 32)
 			{
-				*c = ((char32_t)(utf8[0] & 0x07) << 18) | ((char32_t)(utf8[1] & 0x3F) << 12) | ((char32_t)(utf8[2] & 0x3F) << 6) | (utf8[3] & 0x3F);
-				return 4;
+				__m128i a = _mm_loadu_si128((const __m128i*)in);
+				__m128i b = _mm_loadu_si128((const __m128i*)(in + 4));
+				if (simd_all_zero(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi32((int)0xFFFFFF80))))
+				{
+					_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(_mm_packs_epi32(a, b), a));
+					out += 8;
+					in += 8;
+					continue;
+				}
+				for (int i = 0; i < 2; ++i)
+				{
+					__m128i v = i ? b : a;
+					if (simd_all_zero(_mm_and_si128(v, _mm_set1_epi32((int)0xFFFF0000))))
+					{
+						out = utf8_encode4(out, v);
+						in += 4;
+					}
+					else
+						out = utf_transcode_scalar(out, in, in + 4);
+				}
 			}
+			return out;
 		}
-		inline size_t utf_decode(const unsigned char *utf8, char32_t *c) noexcept
+#endif
+#endif
+
+		// selects the kernels for each pair of code unit sizes; pairs without kernels transcode nothing
+		template <size_t From, size_t To>
+		struct UtfTranscoder
 		{
-			return utf_decode((const char*)utf8, c);
-		}
-		inline size_t utf_decode(const char16_t *utf16, char32_t *c) noexcept
+			template <typename T, typename C>
+			static T* transcode(T *out, T*, const C*&, const C*) noexcept { return out; }
+			template <typename C>
+			static size_t count(const C*&, const C*) noexcept { return 0; }
+		};
+#if defined(SLICE_SIMD_SSE2)
+		template <size_t To>
+		struct UtfTranscoder<1, To>
 		{
-			if (utf16[0] >= 0xD800 && (utf16[0] & 0xFC00) == 0xD800)
+			using U = typename std::conditional<To == 2, char16_t, char32_t>::type;
+			template <typename T, typename C>
+			static T* transcode(T *out, T *outEnd, const C *&in, const C *end) noexcept
 			{
-				*c = ((char32_t)(utf16[0] & 0x3FF) << 10) | (utf16[1] & 0x3FF);
-				return 2;
+# if defined(SLICE_SIMD_SSSE3)
+				return (T*)simd_utf8_decode((U*)out, (U*)outEnd, (const char*&)in, (const char*)end);
+# else
+				(void)outEnd; (void)in; (void)end;
+				return out;
+# endif
 			}
-			else
+			template <typename C>
+			static size_t count(const C *&in, const C *end) noexcept { return simd_utf8_decode_count<U>((const char*&)in, (const char*)end); }
+		};
+		template <>
+		struct UtfTranscoder<2, 1>
+		{
+			template <typename T, typename C>
+			static T* transcode(T *out, T *outEnd, const C *&in, const C *end) noexcept
 			{
-				*c = utf16[0];
-				return 1;
+# if defined(SLICE_SIMD_SSSE3)
+				return (T*)simd_utf8_encode((char*)out, (char*)outEnd, (const char16_t*&)in, (const char16_t*)end);
+# else
+				(void)outEnd; (void)in; (void)end;
+				return out;
+# endif
 			}
-		}
-		inline size_t utf_decode(const char32_t *utf32, char32_t *c) noexcept
+			template <typename C>
+			static size_t count(const C *&in, const C *end) noexcept { return simd_utf16_count<true>((const char16_t*&)in, (const char16_t*)end); }
+		};
+		template <>
+		struct UtfTranscoder<2, 4>
 		{
-			*c = *utf32;
-			return 1;
-		}
-		inline size_t utf_decode(const wchar_t *wc, char32_t *c) noexcept
+			template <typename T, typename C>
+			static T* transcode(T *out, T *outEnd, const C *&in, const C *end) noexcept { return (T*)simd_utf16_to_utf32((char32_t*)out, (char32_t*)outEnd, (const char16_t*&)in, (const char16_t*)end); }
+			template <typename C>
+			static size_t count(const C *&in, const C *end) noexcept { return simd_utf16_count<false>((const char16_t*&)in, (const char16_t*)end); }
+		};
+		template <>
+		struct UtfTranscoder<4, 1>
 		{
-			static_assert(sizeof(wchar_t) == sizeof(char16_t) || sizeof(wchar_t) == sizeof(char32_t), "Unexpected wchar_t size!");
-			if (sizeof(wchar_t) == sizeof(char16_t))
-				return utf_decode((char16_t*)wc, c);
-			else
+			template <typename T, typename C>
+			static T* transcode(T *out, T *outEnd, const C *&in, const C *end) noexcept
 			{
-				*c = (char32_t)*wc;
-				return 1;
+# if defined(SLICE_SIMD_SSSE3)
+				return (T*)simd_utf8_encode((char*)out, (char*)outEnd, (const char32_t*&)in, (const char32_t*)end);
+# else
+				(void)outEnd; (void)in; (void)end;
+				return out;
+# endif
 			}
-		}
+			template <typename C>
+			static size_t count(const C *&in, const C *end) noexcept { return simd_utf32_count<true>((const char32_t*&)in, (const char32_t*)end); }
+		};
+		template <>
+		struct UtfTranscoder<4, 2>
+		{
+			template <typename T, typename C>
+			static T* transcode(T *out, T *outEnd, const C *&in, const C *end) noexcept { return (T*)simd_utf32_to_utf16((char16_t*)out, (char16_t*)outEnd, (const char32_t*&)in, (const char32_t*)end); }
+			template <typename C>
+			static size_t count(const C *&in, const C *end) noexcept { return simd_utf32_count<false>((const char32_t*&)in, (const char32_t*)end); }
+		};
+#endif
 
 		template <typename C, bool S, typename D, bool T>
 		size_t url_encode(Slice<C, S> buffer, Slice<D, T> text) noexcept
@@ -1003,22 +3912,28 @@ namespace beautifulcode
 		: Slice<C, false>(str.data(), str.length()) {}
 #endif
 
+	template<typename C>
+	inline TokenRange<C, detail::LineSplitter<C>> Slice<C, true>::lines() const noexcept
+	{
+		return TokenRange<C, detail::LineSplitter<C>>(*this, detail::LineSplitter<C>());
+	}
+
+	template<typename C>
+	inline size_t Slice<C, true>::validate_utf() const noexcept
+	{
+		return detail::validate_utf(this->ptr, this->length);
+	}
+
 	template<typename C>
 	inline size_t Slice<C, true>::num_chars() const noexcept
 	{
-		Slice<C> t = *this;
-		size_t numChars = 0;
-		while (t.length)
-		{
-			t.pop_front_char();
-			++numChars;
-		}
-		return numChars;
+		return detail::num_chars(this->ptr, this->length);
+	}
+	template<typename C>
+	inline size_t Slice<C, true>::char_offset(size_t index) const noexcept
+	{
+		return detail::char_offset(this->ptr, this->length, index);
 	}
-	template<>
-	inline size_t Slice<char32_t, true>::num_chars() const noexcept { return length; }
-	template<>
-	inline size_t Slice<const char32_t, true>::num_chars() const noexcept { return length; }
 
 	template<typename C>
 	inline char32_t Slice<C, true>::front_char() const noexcept
@@ -1122,10 +4037,8 @@ namespace beautifulcode
 	{
 		if (this->length != str.length)
 			return false;
-		for (size_t i = 0; i < this->length; ++i)
-			if (detail::to_lower(this->ptr[i]) != detail::to_lower(str.ptr[i]))
-				return false;
-		return true;
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::mismatch_ic<U>((const U*)this->ptr, (const U*)str.ptr, this->length) == this->length;
 	}
 	template<typename C>
 	inline bool Slice<C, true>::begins_with_ic(Slice<const C> str) const noexcept
@@ -1144,13 +4057,14 @@ namespace beautifulcode
 	template<typename C>
 	inline ptrdiff_t Slice<C, true>::cmp_ic(Slice<const C> str) const noexcept
 	{
+		using U = typename detail::SizedUint<sizeof(C)>::type;
 		size_t len = this->length < str.length ? this->length : str.length;
-		for (size_t i = 0; i < len; ++i)
+		size_t i = detail::mismatch_ic<U>((const U*)this->ptr, (const U*)str.ptr, len);
+		if (i < len)
 		{
 			C a = detail::to_lower(this->ptr[i]);
 			C b = detail::to_lower(str.ptr[i]);
-			if (a != b)
-				return a < b ? -1 : 1;
+			return a < b ? -1 : 1;
 		}
 		return this->length - str.length;
 	}
@@ -1167,20 +4081,14 @@ namespace beautifulcode
 	template <typename C>
 	inline size_t Slice<C, true>::find_first_ic(C c) const noexcept
 	{
-		c = detail::to_lower(c);
-		size_t offset = 0;
-		while (offset < this->length && detail::to_lower(this->ptr[offset]) != c)
-			++offset;
-		return offset;
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_first_ic<U>((const U*)this->ptr, this->length, (U)c);
 	}
 	template <typename C>
 	inline size_t Slice<C, true>::find_last_ic(C c) const noexcept
 	{
-		c = detail::to_lower(c);
-		ptrdiff_t last = this->length - 1;
-		while (last >= 0 && detail::to_lower(this->ptr[last]) != c)
-			--last;
-		return last < 0 ? this->length : last;
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_last_ic<U>((const U*)this->ptr, this->length, (U)c);
 	}
 
 	template<typename C>
@@ -1188,37 +4096,20 @@ namespace beautifulcode
 	{
 		if (s.empty())
 			return 0;
-		ptrdiff_t len = this->length - s.length;
-		for (ptrdiff_t i = 0; i < len; ++i)
-		{
-			size_t j = 0;
-			for (; j < s.length; ++j)
-			{
-				if (detail::to_lower(this->ptr[i + j]) != detail::to_lower(s.ptr[j]))
-					break;
-			}
-			if (j == s.length)
-				return i;
-		}
-		return this->length;
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		detail::SubstrSearch<U, true> search;
+		search.init((const U*)s.ptr, s.length, detail::SearchForward);
+		return search.find_first((const U*)this->ptr, this->length);
 	}
 	template<typename C>
 	inline size_t Slice<C, true>::find_last_ic(Slice<const C> s) const noexcept
 	{
 		if (s.empty())
 			return this->length;
-		for (ptrdiff_t i = this->length - s.length; i >= 0; --i)
-		{
-			size_t j = 0;
-			for (; j < s.length; ++j)
-			{
-				if (detail::to_lower(this->ptr[i + j]) != detail::to_lower(s.ptr[j]))
-					break;
-			}
-			if (j == s.length)
-				return i;
-		}
-		return this->length;
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		detail::SubstrSearch<U, true> search;
+		search.init((const U*)s.ptr, s.length, detail::SearchReverse);
+		return search.find_last((const U*)this->ptr, this->length);
 	}
 
 	template <typename C>
@@ -1291,27 +4182,143 @@ namespace beautifulcode
 	template<bool Front, bool Back>
 	inline Slice<C> Slice<C, true>::trim() const noexcept
 	{
-		size_t first = 0, last = this->length;
-		if (Front)
+		size_t first = Front ? find_first_not_of<CharClass::Whitespace>() : 0;
+		size_t last = this->length;
+		if (Back && first < last)
+		{
+			size_t tail = Slice<C>(this->ptr + first, last - first).template find_last_not_of<CharClass::Whitespace>();
+			last = tail == last - first ? first : first + tail + 1;
+		}
+		return{ this->ptr + first, last - first };
+	}
+
+	template<typename C>
+	template <CharClass Class>
+	inline size_t Slice<C, true>::find_first_of() const noexcept
+	{
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_first_class<U, Class, true>((const U*)this->ptr, this->length);
+	}
+	template<typename C>
+	template <CharClass Class>
+	inline size_t Slice<C, true>::find_last_of() const noexcept
+	{
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_last_class<U, Class, true>((const U*)this->ptr, this->length);
+	}
+	template<typename C>
+	template <CharClass Class>
+	inline size_t Slice<C, true>::find_first_not_of() const noexcept
+	{
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_first_class<U, Class, false>((const U*)this->ptr, this->length);
+	}
+	template<typename C>
+	template <CharClass Class>
+	inline size_t Slice<C, true>::find_last_not_of() const noexcept
+	{
+		using U = typename detail::SizedUint<sizeof(C)>::type;
+		return detail::find_last_class<U, Class, false>((const U*)this->ptr, this->length);
+	}
+
+	namespace detail
+	{
+		// converts 8 digit values packed in bytes, most significant digit first (lowest address)
+		inline uint32_t swar_8digits(uint64_t v) noexcept
 		{
-			while (first < this->length && detail::is_whitespace(this->ptr[first]))
-				++first;
+			v = v*10 + (v >> 8);
+			v = ((v & 0x000000FF000000FF)*(100 + (1000000ull << 32)) + ((v >> 16) & 0x000000FF000000FF)*(1 + (10000ull << 32))) >> 32;
+			return (uint32_t)v;
 		}
-		if (Back)
+
+		// load up to 8 bytes without reading past the end; missing bytes are zero
+		inline uint64_t load_partial8(const void *p, size_t n) noexcept
 		{
-			while (last > first && detail::is_whitespace(this->ptr[last - 1]))
-				--last;
+			const uint8_t *b = (const uint8_t*)p;
+			if (n >= 8)
+			{
+				uint64_t v;
+				memcpy(&v, b, 8);
+				return v;
+			}
+			if (n >= 4)
+			{
+				// two overlapping loads; the overlapping bytes are the same in both
+				uint32_t lo, hi;
+				memcpy(&lo, b, 4);
+				memcpy(&hi, b + n - 4, 4);
+				return lo | ((uint64_t)hi << ((n - 4)*8));
+			}
+			if (n)
+				return b[0] | ((uint64_t)b[n >> 1] << ((n >> 1)*8)) | ((uint64_t)b[n - 1] << ((n - 1)*8));
+			return 0;
+		}
+
+		// parse decimal digits; returns the number of digits consumed
+		// strings of 1-byte characters are parsed 8 digits at a time
+		template <typename C>
+		inline size_t parse_decimal(const C *s, const C *end, uint64_t &value, bool &overflow) noexcept
+		{
+			static constexpr uint32_t pow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+			const C *p = s;
+			uint64_t v = 0;
+			while (sizeof(C) == 1 && p < end)
+			{
+				// a byte is not a digit if it is >= 10 after removing '0'; carries out of a byte only disturb the bytes
+				// following a non-digit, and only the first non-digit is needed
+				uint64_t block = load_partial8(p, end - p) ^ 0x3030303030303030;
+				uint64_t nonDigit = ((block + 0x7676767676767676) | block) & 0x8080808080808080;
+				size_t n = nonDigit ? ctz64(nonDigit) >> 3 : 8;
+				if (!n)
+				{
+					value = v;
+					return p - s;
+				}
+				uint32_t b = swar_8digits(block << ((8 - n)*8));
+				// 19 digits always fit
+				if (p - s + n <= 19 || v <= (~0ull - b) / pow10[n])
+					v = v*pow10[n] + b;
+				else
+				{
+					v = ~0ull;
+					overflow = true;
+				}
+				p += n;
+				if (n < 8)
+				{
+					value = v;
+					return p - s;
+				}
+			}
+			for (; p < end && is_number(*p); ++p)
+			{
+				unsigned d = (unsigned)(*p - '0');
+				if (p - s >= 19 && v > (~0ull - d) / 10)
+				{
+					v = ~0ull;
+					overflow = true;
+				}
+				else
+					v = v*10 + d;
+			}
+			value = v;
+			return p - s;
 		}
-		return{ this->ptr + first, last - first };
 	}
 
 	template<typename C>
-	inline int64_t Slice<C, true>::parse_int(bool detectBase, int base) const noexcept
+	inline int64_t Slice<C, true>::parse_int(bool detectBase, int base, size_t *taken, bool *overflow) const noexcept
 	{
 		const C *s = this->ptr;
-		const C *end = s + this->length;
-
-		if (this->length == 0)
+		const C *end = this->ptr + this->length;
+		if (s < end && detail::is_whitespace(*s))
+			s += find_first_not_of<CharClass::Whitespace>();
+		if (taken)
+			*taken = 0;
+		if (overflow)
+			*overflow = false;
+
+		if (s == end)
 			return 0; // TODO: perhaps it would be better to throw if the string is not a number?
 
 		if (detectBase)
@@ -1321,7 +4328,7 @@ namespace beautifulcode
 				base = 16;
 				++s;
 			}
-			else if (*s == '0' && detail::to_lower(s[1]) == 'x')
+			else if (*s == '0' && end - s > 1 && detail::to_lower(s[1]) == 'x')
 			{
 				base = 16;
 				s += 2;
@@ -1333,6 +4340,9 @@ namespace beautifulcode
 			}
 		}
 
+		const C *digits;
+		uint64_t number = 0;
+		bool neg = false, over = false;
 		switch (base)
 		{
 			case 2:
@@ -1344,124 +4354,743 @@ namespace beautifulcode
 			case 8:
 			case 9:
 			{
-				int64_t number = 0;
+				digits = s;
 				while (s < end && *s >= '0' && *s < '0' + (C)base)
 				{
-					number = number*base + (*s - '0');
+					unsigned d = (unsigned)(*s - '0');
+					if (number > (~0ull - d) / (unsigned)base)
+						over = true;
+					number = number*base + d;
 					++s;
 				}
-				return number;
+				break;
 			}
 			case 10:
 			{
 				// decimal number
-				bool neg = *s == '-';
-				s += *s == '-' || *s == '+';
-
-				int64_t number = 0;
-				while (s < end && *s >= '0' && *s <= '9')
+				neg = s < end && *s == '-';
+				s += s < end && (*s == '-' || *s == '+');
+				digits = s;
+				s += detail::parse_decimal(s, end, number, over);
+				if (number > (neg ? (uint64_t)1 << 63 : ~0ull >> 1))
 				{
-					number = number * 10 + *s - '0';
-					++s;
+					over = true;
+					number = neg ? (uint64_t)1 << 63 : ~0ull >> 1;
 				}
-				return neg ? -number : number;
+				break;
 			}
 			case 16:
 			{
-				int64_t number = 0;
+				digits = s;
 				while (s < end && detail::is_hex(*s))
 				{
+					if (number >> 60)
+						over = true;
 					number = (number << 4) | (detail::is_number(*s) ? *s - '0' : 10 + (*s | 0x20) - 'a');
 					++s;
 				}
-				return number;
+				break;
 			}
 			default:
 				SLICE_ASSERT(false);
+				return 0;
 		}
-		return 0;
+
+		if (s == digits)
+			return 0;
+		if (over && base != 10)
+			number = ~0ull;
+		if (taken)
+			*taken = s - this->ptr;
+		if (overflow)
+			*overflow = over;
+		return neg ? (int64_t)(0 - number) : (int64_t)number;
 	}
 
-	template<typename C>
-	inline double Slice<C, true>::parse_float() const noexcept
+	namespace detail
 	{
-		if (this->length == 0)
-			return 0;
+		// 128-bit approximations of 5^q for q in [-342, 308], normalised so that the top bit is set
+		inline const uint64_t* power_of_five_128() noexcept
+		{
+			static const uint64_t table[] = {
+				0xEEF453D6923BD65A, 0x113FAA2906A13B3F, 0x9558B4661B6565F8, 0x4AC7CA59A424C507,
+				0xBAAEE17FA23EBF76, 0x5D79BCF00D2DF649, 0xE95A99DF8ACE6F53, 0xF4D82C2C107973DC,
+				0x91D8A02BB6C10594, 0x79071B9B8A4BE869, 0xB64EC836A47146F9, 0x9748E2826CDEE284,
+				0xE3E27A444D8D98B7, 0xFD1B1B2308169B25, 0x8E6D8C6AB0787F72, 0xFE30F0F5E50E20F7,
+				0xB208EF855C969F4F, 0xBDBD2D335E51A935, 0xDE8B2B66B3BC4723, 0xAD2C788035E61382,
+				0x8B16FB203055AC76, 0x4C3BCB5021AFCC31, 0xADDCB9E83C6B1793, 0xDF4ABE242A1BBF3D,
+				0xD953E8624B85DD78, 0xD71D6DAD34A2AF0D, 0x87D4713D6F33AA6B, 0x8672648C40E5AD68,
+				0xA9C98D8CCB009506, 0x680EFDAF511F18C2, 0xD43BF0EFFDC0BA48, 0x0212BD1B2566DEF2,
+				0x84A57695FE98746D, 0x014BB630F7604B57, 0xA5CED43B7E3E9188, 0x419EA3BD35385E2D,
+				0xCF42894A5DCE35EA, 0x52064CAC828675B9, 0x818995CE7AA0E1B2, 0x7343EFEBD1940993,
+				0xA1EBFB4219491A1F, 0x1014EBE6C5F90BF8, 0xCA66FA129F9B60A6, 0xD41A26E077774EF6,
+				0xFD00B897478238D0, 0x8920B098955522B4, 0x9E20735E8CB16382, 0x55B46E5F5D5535B0,
+				0xC5A890362FDDBC62, 0xEB2189F734AA831D, 0xF712B443BBD52B7B, 0xA5E9EC7501D523E4,
+				0x9A6BB0AA55653B2D, 0x47B233C92125366E, 0xC1069CD4EABE89F8, 0x999EC0BB696E840A,
+				0xF148440A256E2C76, 0xC00670EA43CA250D, 0x96CD2A865764DBCA, 0x380406926A5E5728,
+				0xBC807527ED3E12BC, 0xC605083704F5ECF2, 0xEBA09271E88D976B, 0xF7864A44C633682E,
+				0x93445B8731587EA3, 0x7AB3EE6AFBE0211D, 0xB8157268FDAE9E4C, 0x5960EA05BAD82964,
+				0xE61ACF033D1A45DF, 0x6FB92487298E33BD, 0x8FD0C16206306BAB, 0xA5D3B6D479F8E056,
+				0xB3C4F1BA87BC8696, 0x8F48A4899877186C, 0xE0B62E2929ABA83C, 0x331ACDABFE94DE87,
+				0x8C71DCD9BA0B4925, 0x9FF0C08B7F1D0B14, 0xAF8E5410288E1B6F, 0x07ECF0AE5EE44DD9,
+				0xDB71E91432B1A24A, 0xC9E82CD9F69D6150, 0x892731AC9FAF056E, 0xBE311C083A225CD2,
+				0xAB70FE17C79AC6CA, 0x6DBD630A48AAF406, 0xD64D3D9DB981787D, 0x092CBBCCDAD5B108,
+				0x85F0468293F0EB4E, 0x25BBF56008C58EA5, 0xA76C582338ED2621, 0xAF2AF2B80AF6F24E,
+				0xD1476E2C07286FAA, 0x1AF5AF660DB4AEE1, 0x82CCA4DB847945CA, 0x50D98D9FC890ED4D,
+				0xA37FCE126597973C, 0xE50FF107BAB528A0, 0xCC5FC196FEFD7D0C, 0x1E53ED49A96272C8,
+				0xFF77B1FCBEBCDC4F, 0x25E8E89C13BB0F7A, 0x9FAACF3DF73609B1, 0x77B191618C54E9AC,
+				0xC795830D75038C1D, 0xD59DF5B9EF6A2417, 0xF97AE3D0D2446F25, 0x4B0573286B44AD1D,
+				0x9BECCE62836AC577, 0x4EE367F9430AEC32, 0xC2E801FB244576D5, 0x229C41F793CDA73F,
+				0xF3A20279ED56D48A, 0x6B43527578C1110F, 0x9845418C345644D6, 0x830A13896B78AAA9,
+				0xBE5691EF416BD60C, 0x23CC986BC656D553, 0xEDEC366B11C6CB8F, 0x2CBFBE86B7EC8AA8,
+				0x94B3A202EB1C3F39, 0x7BF7D71432F3D6A9, 0xB9E08A83A5E34F07, 0xDAF5CCD93FB0CC53,
+				0xE858AD248F5C22C9, 0xD1B3400F8F9CFF68, 0x91376C36D99995BE, 0x23100809B9C21FA1,
+				0xB58547448FFFFB2D, 0xABD40A0C2832A78A, 0xE2E69915B3FFF9F9, 0x16C90C8F323F516C,
+				0x8DD01FAD907FFC3B, 0xAE3DA7D97F6792E3, 0xB1442798F49FFB4A, 0x99CD11CFDF41779C,
+				0xDD95317F31C7FA1D, 0x40405643D711D583, 0x8A7D3EEF7F1CFC52, 0x482835EA666B2572,
+				0xAD1C8EAB5EE43B66, 0xDA3243650005EECF, 0xD863B256369D4A40, 0x90BED43E40076A82,
+				0x873E4F75E2224E68, 0x5A7744A6E804A291, 0xA90DE3535AAAE202, 0x711515D0A205CB36,
+				0xD3515C2831559A83, 0x0D5A5B44CA873E03, 0x8412D9991ED58091, 0xE858790AFE9486C2,
+				0xA5178FFF668AE0B6, 0x626E974DBE39A872, 0xCE5D73FF402D98E3, 0xFB0A3D212DC8128F,
+				0x80FA687F881C7F8E, 0x7CE66634BC9D0B99, 0xA139029F6A239F72, 0x1C1FFFC1EBC44E80,
+				0xC987434744AC874E, 0xA327FFB266B56220, 0xFBE9141915D7A922, 0x4BF1FF9F0062BAA8,
+				0x9D71AC8FADA6C9B5, 0x6F773FC3603DB4A9, 0xC4CE17B399107C22, 0xCB550FB4384D21D3,
+				0xF6019DA07F549B2B, 0x7E2A53A146606A48, 0x99C102844F94E0FB, 0x2EDA7444CBFC426D,
+				0xC0314325637A1939, 0xFA911155FEFB5308, 0xF03D93EEBC589F88, 0x793555AB7EBA27CA,
+				0x96267C7535B763B5, 0x4BC1558B2F3458DE, 0xBBB01B9283253CA2, 0x9EB1AAEDFB016F16,
+				0xEA9C227723EE8BCB, 0x465E15A979C1CADC, 0x92A1958A7675175F, 0x0BFACD89EC191EC9,
+				0xB749FAED14125D36, 0xCEF980EC671F667B, 0xE51C79A85916F484, 0x82B7E12780E7401A,
+				0x8F31CC0937AE58D2, 0xD1B2ECB8B0908810, 0xB2FE3F0B8599EF07, 0x861FA7E6DCB4AA15,
+				0xDFBDCECE67006AC9, 0x67A791E093E1D49A, 0x8BD6A141006042BD, 0xE0C8BB2C5C6D24E0,
+				0xAECC49914078536D, 0x58FAE9F773886E18, 0xDA7F5BF590966848, 0xAF39A475506A899E,
+				0x888F99797A5E012D, 0x6D8406C952429603, 0xAAB37FD7D8F58178, 0xC8E5087BA6D33B83,
+				0xD5605FCDCF32E1D6, 0xFB1E4A9A90880A64, 0x855C3BE0A17FCD26, 0x5CF2EEA09A55067F,
+				0xA6B34AD8C9DFC06F, 0xF42FAA48C0EA481E, 0xD0601D8EFC57B08B, 0xF13B94DAF124DA26,
+				0x823C12795DB6CE57, 0x76C53D08D6B70858, 0xA2CB1717B52481ED, 0x54768C4B0C64CA6E,
+				0xCB7DDCDDA26DA268, 0xA9942F5DCF7DFD09, 0xFE5D54150B090B02, 0xD3F93B35435D7C4C,
+				0x9EFA548D26E5A6E1, 0xC47BC5014A1A6DAF, 0xC6B8E9B0709F109A, 0x359AB6419CA1091B,
+				0xF867241C8CC6D4C0, 0xC30163D203C94B62, 0x9B407691D7FC44F8, 0x79E0DE63425DCF1D,
+				0xC21094364DFB5636, 0x985915FC12F542E4, 0xF294B943E17A2BC4, 0x3E6F5B7B17B2939D,
+				0x979CF3CA6CEC5B5A, 0xA705992CEECF9C42, 0xBD8430BD08277231, 0x50C6FF782A838353,
+				0xECE53CEC4A314EBD, 0xA4F8BF5635246428, 0x940F4613AE5ED136, 0x871B7795E136BE99,
+				0xB913179899F68584, 0x28E2557B59846E3F, 0xE757DD7EC07426E5, 0x331AEADA2FE589CF,
+				0x9096EA6F3848984F, 0x3FF0D2C85DEF7621, 0xB4BCA50B065ABE63, 0x0FED077A756B53A9,
+				0xE1EBCE4DC7F16DFB, 0xD3E8495912C62894, 0x8D3360F09CF6E4BD, 0x64712DD7ABBBD95C,
+				0xB080392CC4349DEC, 0xBD8D794D96AACFB3, 0xDCA04777F541C567, 0xECF0D7A0FC5583A0,
+				0x89E42CAAF9491B60, 0xF41686C49DB57244, 0xAC5D37D5B79B6239, 0x311C2875C522CED5,
+				0xD77485CB25823AC7, 0x7D633293366B828B, 0x86A8D39EF77164BC, 0xAE5DFF9C02033197,
+				0xA8530886B54DBDEB, 0xD9F57F830283FDFC, 0xD267CAA862A12D66, 0xD072DF63C324FD7B,
+				0x8380DEA93DA4BC60, 0x4247CB9E59F71E6D, 0xA46116538D0DEB78, 0x52D9BE85F074E608,
+				0xCD795BE870516656, 0x67902E276C921F8B, 0x806BD9714632DFF6, 0x00BA1CD8A3DB53B6,
+				0xA086CFCD97BF97F3, 0x80E8A40ECCD228A4, 0xC8A883C0FDAF7DF0, 0x6122CD128006B2CD,
+				0xFAD2A4B13D1B5D6C, 0x796B805720085F81, 0x9CC3A6EEC6311A63, 0xCBE3303674053BB0,
+				0xC3F490AA77BD60FC, 0xBEDBFC4411068A9C, 0xF4F1B4D515ACB93B, 0xEE92FB5515482D44,
+				0x991711052D8BF3C5, 0x751BDD152D4D1C4A, 0xBF5CD54678EEF0B6, 0xD262D45A78A0635D,
+				0xEF340A98172AACE4, 0x86FB897116C87C34, 0x9580869F0E7AAC0E, 0xD45D35E6AE3D4DA0,
+				0xBAE0A846D2195712, 0x8974836059CCA109, 0xE998D258869FACD7, 0x2BD1A438703FC94B,
+				0x91FF83775423CC06, 0x7B6306A34627DDCF, 0xB67F6455292CBF08, 0x1A3BC84C17B1D542,
+				0xE41F3D6A7377EECA, 0x20CABA5F1D9E4A93, 0x8E938662882AF53E, 0x547EB47B7282EE9C,
+				0xB23867FB2A35B28D, 0xE99E619A4F23AA43, 0xDEC681F9F4C31F31, 0x6405FA00E2EC94D4,
+				0x8B3C113C38F9F37E, 0xDE83BC408DD3DD04, 0xAE0B158B4738705E, 0x9624AB50B148D445,
+				0xD98DDAEE19068C76, 0x3BADD624DD9B0957, 0x87F8A8D4CFA417C9, 0xE54CA5D70A80E5D6,
+				0xA9F6D30A038D1DBC, 0x5E9FCF4CCD211F4C, 0xD47487CC8470652B, 0x7647C3200069671F,
+				0x84C8D4DFD2C63F3B, 0x29ECD9F40041E073, 0xA5FB0A17C777CF09, 0xF468107100525890,
+				0xCF79CC9DB955C2CC, 0x7182148D4066EEB4, 0x81AC1FE293D599BF, 0xC6F14CD848405530,
+				0xA21727DB38CB002F, 0xB8ADA00E5A506A7C, 0xCA9CF1D206FDC03B, 0xA6D90811F0E4851C,
+				0xFD442E4688BD304A, 0x908F4A166D1DA663, 0x9E4A9CEC15763E2E, 0x9A598E4E043287FE,
+				0xC5DD44271AD3CDBA, 0x40EFF1E1853F29FD, 0xF7549530E188C128, 0xD12BEE59E68EF47C,
+				0x9A94DD3E8CF578B9, 0x82BB74F8301958CE, 0xC13A148E3032D6E7, 0xE36A52363C1FAF01,
+				0xF18899B1BC3F8CA1, 0xDC44E6C3CB279AC1, 0x96F5600F15A7B7E5, 0x29AB103A5EF8C0B9,
+				0xBCB2B812DB11A5DE, 0x7415D448F6B6F0E7, 0xEBDF661791D60F56, 0x111B495B3464AD21,
+				0x936B9FCEBB25C995, 0xCAB10DD900BEEC34, 0xB84687C269EF3BFB, 0x3D5D514F40EEA742,
+				0xE65829B3046B0AFA, 0x0CB4A5A3112A5112, 0x8FF71A0FE2C2E6DC, 0x47F0E785EABA72AB,
+				0xB3F4E093DB73A093, 0x59ED216765690F56, 0xE0F218B8D25088B8, 0x306869C13EC3532C,
+				0x8C974F7383725573, 0x1E414218C73A13FB, 0xAFBD2350644EEACF, 0xE5D1929EF90898FA,
+				0xDBAC6C247D62A583, 0xDF45F746B74ABF39, 0x894BC396CE5DA772, 0x6B8BBA8C328EB783,
+				0xAB9EB47C81F5114F, 0x066EA92F3F326564, 0xD686619BA27255A2, 0xC80A537B0EFEFEBD,
+				0x8613FD0145877585, 0xBD06742CE95F5F36, 0xA798FC4196E952E7, 0x2C48113823B73704,
+				0xD17F3B51FCA3A7A0, 0xF75A15862CA504C5, 0x82EF85133DE648C4, 0x9A984D73DBE722FB,
+				0xA3AB66580D5FDAF5, 0xC13E60D0D2E0EBBA, 0xCC963FEE10B7D1B3, 0x318DF905079926A8,
+				0xFFBBCFE994E5C61F, 0xFDF17746497F7052, 0x9FD561F1FD0F9BD3, 0xFEB6EA8BEDEFA633,
+				0xC7CABA6E7C5382C8, 0xFE64A52EE96B8FC0, 0xF9BD690A1B68637B, 0x3DFDCE7AA3C673B0,
+				0x9C1661A651213E2D, 0x06BEA10CA65C084E, 0xC31BFA0FE5698DB8, 0x486E494FCFF30A62,
+				0xF3E2F893DEC3F126, 0x5A89DBA3C3EFCCFA, 0x986DDB5C6B3A76B7, 0xF89629465A75E01C,
+				0xBE89523386091465, 0xF6BBB397F1135823, 0xEE2BA6C0678B597F, 0x746AA07DED582E2C,
+				0x94DB483840B717EF, 0xA8C2A44EB4571CDC, 0xBA121A4650E4DDEB, 0x92F34D62616CE413,
+				0xE896A0D7E51E1566, 0x77B020BAF9C81D17, 0x915E2486EF32CD60, 0x0ACE1474DC1D122E,
+				0xB5B5ADA8AAFF80B8, 0x0D819992132456BA, 0xE3231912D5BF60E6, 0x10E1FFF697ED6C69,
+				0x8DF5EFABC5979C8F, 0xCA8D3FFA1EF463C1, 0xB1736B96B6FD83B3, 0xBD308FF8A6B17CB2,
+				0xDDD0467C64BCE4A0, 0xAC7CB3F6D05DDBDE, 0x8AA22C0DBEF60EE4, 0x6BCDF07A423AA96B,
+				0xAD4AB7112EB3929D, 0x86C16C98D2C953C6, 0xD89D64D57A607744, 0xE871C7BF077BA8B7,
+				0x87625F056C7C4A8B, 0x11471CD764AD4972, 0xA93AF6C6C79B5D2D, 0xD598E40D3DD89BCF,
+				0xD389B47879823479, 0x4AFF1D108D4EC2C3, 0x843610CB4BF160CB, 0xCEDF722A585139BA,
+				0xA54394FE1EEDB8FE, 0xC2974EB4EE658828, 0xCE947A3DA6A9273E, 0x733D226229FEEA32,
+				0x811CCC668829B887, 0x0806357D5A3F525F, 0xA163FF802A3426A8, 0xCA07C2DCB0CF26F7,
+				0xC9BCFF6034C13052, 0xFC89B393DD02F0B5, 0xFC2C3F3841F17C67, 0xBBAC2078D443ACE2,
+				0x9D9BA7832936EDC0, 0xD54B944B84AA4C0D, 0xC5029163F384A931, 0x0A9E795E65D4DF11,
+				0xF64335BCF065D37D, 0x4D4617B5FF4A16D5, 0x99EA0196163FA42E, 0x504BCED1BF8E4E45,
+				0xC06481FB9BCF8D39, 0xE45EC2862F71E1D6, 0xF07DA27A82C37088, 0x5D767327BB4E5A4C,
+				0x964E858C91BA2655, 0x3A6A07F8D510F86F, 0xBBE226EFB628AFEA, 0x890489F70A55368B,
+				0xEADAB0ABA3B2DBE5, 0x2B45AC74CCEA842E, 0x92C8AE6B464FC96F, 0x3B0B8BC90012929D,
+				0xB77ADA0617E3BBCB, 0x09CE6EBB40173744, 0xE55990879DDCAABD, 0xCC420A6A101D0515,
+				0x8F57FA54C2A9EAB6, 0x9FA946824A12232D, 0xB32DF8E9F3546564, 0x47939822DC96ABF9,
+				0xDFF9772470297EBD, 0x59787E2B93BC56F7, 0x8BFBEA76C619EF36, 0x57EB4EDB3C55B65A,
+				0xAEFAE51477A06B03, 0xEDE622920B6B23F1, 0xDAB99E59958885C4, 0xE95FAB368E45ECED,
+				0x88B402F7FD75539B, 0x11DBCB0218EBB414, 0xAAE103B5FCD2A881, 0xD652BDC29F26A119,
+				0xD59944A37C0752A2, 0x4BE76D3346F0495F, 0x857FCAE62D8493A5, 0x6F70A4400C562DDB,
+				0xA6DFBD9FB8E5B88E, 0xCB4CCD500F6BB952, 0xD097AD07A71F26B2, 0x7E2000A41346A7A7,
+				0x825ECC24C873782F, 0x8ED400668C0C28C8, 0xA2F67F2DFA90563B, 0x728900802F0F32FA,
+				0xCBB41EF979346BCA, 0x4F2B40A03AD2FFB9, 0xFEA126B7D78186BC, 0xE2F610C84987BFA8,
+				0x9F24B832E6B0F436, 0x0DD9CA7D2DF4D7C9, 0xC6EDE63FA05D3143, 0x91503D1C79720DBB,
+				0xF8A95FCF88747D94, 0x75A44C6397CE912A, 0x9B69DBE1B548CE7C, 0xC986AFBE3EE11ABA,
+				0xC24452DA229B021B, 0xFBE85BADCE996168, 0xF2D56790AB41C2A2, 0xFAE27299423FB9C3,
+				0x97C560BA6B0919A5, 0xDCCD879FC967D41A, 0xBDB6B8E905CB600F, 0x5400E987BBC1C920,
+				0xED246723473E3813, 0x290123E9AAB23B68, 0x9436C0760C86E30B, 0xF9A0B6720AAF6521,
+				0xB94470938FA89BCE, 0xF808E40E8D5B3E69, 0xE7958CB87392C2C2, 0xB60B1D1230B20E04,
+				0x90BD77F3483BB9B9, 0xB1C6F22B5E6F48C2, 0xB4ECD5F01A4AA828, 0x1E38AEB6360B1AF3,
+				0xE2280B6C20DD5232, 0x25C6DA63C38DE1B0, 0x8D590723948A535F, 0x579C487E5A38AD0E,
+				0xB0AF48EC79ACE837, 0x2D835A9DF0C6D851, 0xDCDB1B2798182244, 0xF8E431456CF88E65,
+				0x8A08F0F8BF0F156B, 0x1B8E9ECB641B58FF, 0xAC8B2D36EED2DAC5, 0xE272467E3D222F3F,
+				0xD7ADF884AA879177, 0x5B0ED81DCC6ABB0F, 0x86CCBB52EA94BAEA, 0x98E947129FC2B4E9,
+				0xA87FEA27A539E9A5, 0x3F2398D747B36224, 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD,
+				0x83A3EEEEF9153E89, 0x1953CF68300424AC, 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7,
+				0xCDB02555653131B6, 0x3792F412CB06794D, 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0,
+				0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4, 0xC8DE047564D20A8B, 0xF245825A5A445275,
+				0xFB158592BE068D2E, 0xEED6E2F0F0D56712, 0x9CED737BB6C4183D, 0x55464DD69685606B,
+				0xC428D05AA4751E4C, 0xAA97E14C3C26B886, 0xF53304714D9265DF, 0xD53DD99F4B3066A8,
+				0x993FE2C6D07B7FAB, 0xE546A8038EFE4029, 0xBF8FDB78849A5F96, 0xDE98520472BDD033,
+				0xEF73D256A5C0F77C, 0x963E66858F6D4440, 0x95A8637627989AAD, 0xDDE7001379A44AA8,
+				0xBB127C53B17EC159, 0x5560C018580D5D52, 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6,
+				0x9226712162AB070D, 0xCAB3961304CA70E8, 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22,
+				0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A, 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242,
+				0xB267ED1940F1C61C, 0x55F038B237591ED3, 0xDF01E85F912E37A3, 0x6B6C46DEC52F6688,
+				0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015, 0xAE397D8AA96C1B77, 0xABEC975E0A0D081A,
+				0xD9C7DCED53C72255, 0x96E7BD358C904A21, 0x881CEA14545C7575, 0x7E50D64177DA2E54,
+				0xAA242499697392D2, 0xDDE50BD1D5D0B9E9, 0xD4AD2DBFC3D07787, 0x955E4EC64B44E864,
+				0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E, 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E,
+				0xCFB11EAD453994BA, 0x67DE18EDA5814AF2, 0x81CEB32C4B43FCF4, 0x80EACF948770CED7,
+				0xA2425FF75E14FC31, 0xA1258379A94D028D, 0xCAD2F7F5359A3B3E, 0x096EE45813A04330,
+				0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC, 0x9E74D1B791E07E48, 0x775EA264CF55347E,
+				0xC612062576589DDA, 0x95364AFE032A819E, 0xF79687AED3EEC551, 0x3A83DDBD83F52205,
+				0x9ABE14CD44753B52, 0xC4926A9672793543, 0xC16D9A0095928A27, 0x75B7053C0F178294,
+				0xF1C90080BAF72CB1, 0x5324C68B12DD6339, 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04,
+				0xBCE5086492111AEA, 0x88F4BB1CA6BCF585, 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6,
+				0x9392EE8E921D5D07, 0x3AFF322E62439FD0, 0xB877AA3236A4B449, 0x09BEFEB9FAD487C3,
+				0xE69594BEC44DE15B, 0x4C2EBE687989A9B4, 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11,
+				0xB424DC35095CD80F, 0x538484C19EF38C95, 0xE12E13424BB40E13, 0x2865A5F206B06FBA,
+				0x8CBCCC096F5088CB, 0xF93F87B7442E45D4, 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749,
+				0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C, 0x89705F4136B4A597, 0x31680A88F8953031,
+				0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E, 0xD6BF94D5E57A42BC, 0x3D32907604691B4D,
+				0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110, 0xA7C5AC471B478423, 0x0FCF80DC33721D54,
+				0xD1B71758E219652B, 0xD3C36113404EA4A9, 0x83126E978D4FDF3B, 0x645A1CAC083126EA,
+				0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4, 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD,
+				0x8000000000000000, 0x0000000000000000, 0xA000000000000000, 0x0000000000000000,
+				0xC800000000000000, 0x0000000000000000, 0xFA00000000000000, 0x0000000000000000,
+				0x9C40000000000000, 0x0000000000000000, 0xC350000000000000, 0x0000000000000000,
+				0xF424000000000000, 0x0000000000000000, 0x9896800000000000, 0x0000000000000000,
+				0xBEBC200000000000, 0x0000000000000000, 0xEE6B280000000000, 0x0000000000000000,
+				0x9502F90000000000, 0x0000000000000000, 0xBA43B74000000000, 0x0000000000000000,
+				0xE8D4A51000000000, 0x0000000000000000, 0x9184E72A00000000, 0x0000000000000000,
+				0xB5E620F480000000, 0x0000000000000000, 0xE35FA931A0000000, 0x0000000000000000,
+				0x8E1BC9BF04000000, 0x0000000000000000, 0xB1A2BC2EC5000000, 0x0000000000000000,
+				0xDE0B6B3A76400000, 0x0000000000000000, 0x8AC7230489E80000, 0x0000000000000000,
+				0xAD78EBC5AC620000, 0x0000000000000000, 0xD8D726B7177A8000, 0x0000000000000000,
+				0x878678326EAC9000, 0x0000000000000000, 0xA968163F0A57B400, 0x0000000000000000,
+				0xD3C21BCECCEDA100, 0x0000000000000000, 0x84595161401484A0, 0x0000000000000000,
+				0xA56FA5B99019A5C8, 0x0000000000000000, 0xCECB8F27F4200F3A, 0x0000000000000000,
+				0x813F3978F8940984, 0x4000000000000000, 0xA18F07D736B90BE5, 0x5000000000000000,
+				0xC9F2C9CD04674EDE, 0xA400000000000000, 0xFC6F7C4045812296, 0x4D00000000000000,
+				0x9DC5ADA82B70B59D, 0xF020000000000000, 0xC5371912364CE305, 0x6C28000000000000,
+				0xF684DF56C3E01BC6, 0xC732000000000000, 0x9A130B963A6C115C, 0x3C7F400000000000,
+				0xC097CE7BC90715B3, 0x4B9F100000000000, 0xF0BDC21ABB48DB20, 0x1E86D40000000000,
+				0x96769950B50D88F4, 0x1314448000000000, 0xBC143FA4E250EB31, 0x17D955A000000000,
+				0xEB194F8E1AE525FD, 0x5DCFAB0800000000, 0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000,
+				0xB7ABC627050305AD, 0xF14A3D9E40000000, 0xE596B7B0C643C719, 0x6D9CCD05D0000000,
+				0x8F7E32CE7BEA5C6F, 0xE4820023A2000000, 0xB35DBF821AE4F38B, 0xDDA2802C8A800000,
+				0xE0352F62A19E306E, 0xD50B2037AD200000, 0x8C213D9DA502DE45, 0x4526F422CC340000,
+				0xAF298D050E4395D6, 0x9670B12B7F410000, 0xDAF3F04651D47B4C, 0x3C0CDD765F114000,
+				0x88D8762BF324CD0F, 0xA5880A69FB6AC800, 0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00,
+				0xD5D238A4ABE98068, 0x72A4904598D6D880, 0x85A36366EB71F041, 0x47A6DA2B7F864750,
+				0xA70C3C40A64E6C51, 0x999090B65F67D924, 0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D,
+				0x82818F1281ED449F, 0xBFF8F10E7A8921A4, 0xA321F2D7226895C7, 0xAFF72D52192B6A0D,
+				0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490, 0xFEE50B7025C36A08, 0x02F236D04753D5B4,
+				0x9F4F2726179A2245, 0x01D762422C946590, 0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5,
+				0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2, 0x9B934C3B330C8577, 0x63CC55F49F88EB2F,
+				0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB, 0xF316271C7FC3908A, 0x8BEF464E3945EF7A,
+				0x97EDD871CFDA3A56, 0x97758BF0E3CBB5AC, 0xBDE94E8E43D0C8EC, 0x3D52EEED1CBEA317,
+				0xED63A231D4C4FB27, 0x4CA7AAA863EE4BDD, 0x945E455F24FB1CF8, 0x8FE8CAA93E74EF6A,
+				0xB975D6B6EE39E436, 0xB3E2FD538E122B44, 0xE7D34C64A9C85D44, 0x60DBBCA87196B616,
+				0x90E40FBEEA1D3A4A, 0xBC8955E946FE31CD, 0xB51D13AEA4A488DD, 0x6BABAB6398BDBE41,
+				0xE264589A4DCDAB14, 0xC696963C7EED2DD1, 0x8D7EB76070A08AEC, 0xFC1E1DE5CF543CA2,
+				0xB0DE65388CC8ADA8, 0x3B25A55F43294BCB, 0xDD15FE86AFFAD912, 0x49EF0EB713F39EBE,
+				0x8A2DBF142DFCC7AB, 0x6E3569326C784337, 0xACB92ED9397BF996, 0x49C2C37F07965404,
+				0xD7E77A8F87DAF7FB, 0xDC33745EC97BE906, 0x86F0AC99B4E8DAFD, 0x69A028BB3DED71A3,
+				0xA8ACD7C0222311BC, 0xC40832EA0D68CE0C, 0xD2D80DB02AABD62B, 0xF50A3FA490C30190,
+				0x83C7088E1AAB65DB, 0x792667C6DA79E0FA, 0xA4B8CAB1A1563F52, 0x577001B891185938,
+				0xCDE6FD5E09ABCF26, 0xED4C0226B55E6F86, 0x80B05E5AC60B6178, 0x544F8158315B05B4,
+				0xA0DC75F1778E39D6, 0x696361AE3DB1C721, 0xC913936DD571C84C, 0x03BC3A19CD1E38E9,
+				0xFB5878494ACE3A5F, 0x04AB48A04065C723, 0x9D174B2DCEC0E47B, 0x62EB0D64283F9C76,
+				0xC45D1DF942711D9A, 0x3BA5D0BD324F8394, 0xF5746577930D6500, 0xCA8F44EC7EE36479,
+				0x9968BF6ABBE85F20, 0x7E998B13CF4E1ECB, 0xBFC2EF456AE276E8, 0x9E3FEDD8C321A67E,
+				0xEFB3AB16C59B14A2, 0xC5CFE94EF3EA101E, 0x95D04AEE3B80ECE5, 0xBBA1F1D158724A12,
+				0xBB445DA9CA61281F, 0x2A8A6E45AE8EDC97, 0xEA1575143CF97226, 0xF52D09D71A3293BD,
+				0x924D692CA61BE758, 0x593C2626705F9C56, 0xB6E0C377CFA2E12E, 0x6F8B2FB00C77836C,
+				0xE498F455C38B997A, 0x0B6DFB9C0F956447, 0x8EDF98B59A373FEC, 0x4724BD4189BD5EAC,
+				0xB2977EE300C50FE7, 0x58EDEC91EC2CB657, 0xDF3D5E9BC0F653E1, 0x2F2967B66737E3ED,
+				0x8B865B215899F46C, 0xBD79E0D20082EE74, 0xAE67F1E9AEC07187, 0xECD8590680A3AA11,
+				0xDA01EE641A708DE9, 0xE80E6F4820CC9495, 0x884134FE908658B2, 0x3109058D147FDCDD,
+				0xAA51823E34A7EEDE, 0xBD4B46F0599FD415, 0xD4E5E2CDC1D1EA96, 0x6C9E18AC7007C91A,
+				0x850FADC09923329E, 0x03E2CF6BC604DDB0, 0xA6539930BF6BFF45, 0x84DB8346B786151C,
+				0xCFE87F7CEF46FF16, 0xE612641865679A63, 0x81F14FAE158C5F6E, 0x4FCB7E8F3F60C07E,
+				0xA26DA3999AEF7749, 0xE3BE5E330F38F09D, 0xCB090C8001AB551C, 0x5CADF5BFD3072CC5,
+				0xFDCB4FA002162A63, 0x73D9732FC7C8F7F6, 0x9E9F11C4014DDA7E, 0x2867E7FDDCDD9AFA,
+				0xC646D63501A1511D, 0xB281E1FD541501B8, 0xF7D88BC24209A565, 0x1F225A7CA91A4226,
+				0x9AE757596946075F, 0x3375788DE9B06958, 0xC1A12D2FC3978937, 0x0052D6B1641C83AE,
+				0xF209787BB47D6B84, 0xC0678C5DBD23A49A, 0x9745EB4D50CE6332, 0xF840B7BA963646E0,
+				0xBD176620A501FBFF, 0xB650E5A93BC3D898, 0xEC5D3FA8CE427AFF, 0xA3E51F138AB4CEBE,
+				0x93BA47C980E98CDF, 0xC66F336C36B10137, 0xB8A8D9BBE123F017, 0xB80B0047445D4184,
+				0xE6D3102AD96CEC1D, 0xA60DC059157491E5, 0x9043EA1AC7E41392, 0x87C89837AD68DB2F,
+				0xB454E4A179DD1877, 0x29BABE4598C311FB, 0xE16A1DC9D8545E94, 0xF4296DD6FEF3D67A,
+				0x8CE2529E2734BB1D, 0x1899E4A65F58660C, 0xB01AE745B101E9E4, 0x5EC05DCFF72E7F8F,
+				0xDC21A1171D42645D, 0x76707543F4FA1F73, 0x899504AE72497EBA, 0x6A06494A791C53A8,
+				0xABFA45DA0EDBDE69, 0x0487DB9D17636892, 0xD6F8D7509292D603, 0x45A9D2845D3C42B6,
+				0x865B86925B9BC5C2, 0x0B8A2392BA45A9B2, 0xA7F26836F282B732, 0x8E6CAC7768D7141E,
+				0xD1EF0244AF2364FF, 0x3207D795430CD926, 0x8335616AED761F1F, 0x7F44E6BD49E807B8,
+				0xA402B9C5A8D3A6E7, 0x5F16206C9C6209A6, 0xCD036837130890A1, 0x36DBA887C37A8C0F,
+				0x802221226BE55A64, 0xC2494954DA2C9789, 0xA02AA96B06DEB0FD, 0xF2DB9BAA10B7BD6C,
+				0xC83553C5C8965D3D, 0x6F92829494E5ACC7, 0xFA42A8B73ABBF48C, 0xCB772339BA1F17F9,
+				0x9C69A97284B578D7, 0xFF2A760414536EFB, 0xC38413CF25E2D70D, 0xFEF5138519684ABA,
+				0xF46518C2EF5B8CD1, 0x7EB258665FC25D69, 0x98BF2F79D5993802, 0xEF2F773FFBD97A61,
+				0xBEEEFB584AFF8603, 0xAAFB550FFACFD8FA, 0xEEAABA2E5DBF6784, 0x95BA2A53F983CF38,
+				0x952AB45CFA97A0B2, 0xDD945A747BF26183, 0xBA756174393D88DF, 0x94F971119AEEF9E4,
+				0xE912B9D1478CEB17, 0x7A37CD5601AAB85D, 0x91ABB422CCB812EE, 0xAC62E055C10AB33A,
+				0xB616A12B7FE617AA, 0x577B986B314D6009, 0xE39C49765FDF9D94, 0xED5A7E85FDA0B80B,
+				0x8E41ADE9FBEBC27D, 0x14588F13BE847307, 0xB1D219647AE6B31C, 0x596EB2D8AE258FC8,
+				0xDE469FBD99A05FE3, 0x6FCA5F8ED9AEF3BB, 0x8AEC23D680043BEE, 0x25DE7BB9480D5854,
+				0xADA72CCC20054AE9, 0xAF561AA79A10AE6A, 0xD910F7FF28069DA4, 0x1B2BA1518094DA04,
+				0x87AA9AFF79042286, 0x90FB44D2F05D0842, 0xA99541BF57452B28, 0x353A1607AC744A53,
+				0xD3FA922F2D1675F2, 0x42889B8997915CE8, 0x847C9B5D7C2E09B7, 0x69956135FEBADA11,
+				0xA59BC234DB398C25, 0x43FAB9837E699095, 0xCF02B2C21207EF2E, 0x94F967E45E03F4BB,
+				0x8161AFB94B44F57D, 0x1D1BE0EEBAC278F5, 0xA1BA1BA79E1632DC, 0x6462D92A69731732,
+				0xCA28A291859BBF93, 0x7D7B8F7503CFDCFE, 0xFCB2CB35E702AF78, 0x5CDA735244C3D43E,
+				0x9DEFBF01B061ADAB, 0x3A0888136AFA64A7, 0xC56BAEC21C7A1916, 0x088AAA1845B8FDD0,
+				0xF6C69A72A3989F5B, 0x8AAD549E57273D45, 0x9A3C2087A63F6399, 0x36AC54E2F678864B,
+				0xC0CB28A98FCF3C7F, 0x84576A1BB416A7DD, 0xF0FDF2D3F3C30B9F, 0x656D44A2A11C51D5,
+				0x969EB7C47859E743, 0x9F644AE5A4B1B325, 0xBC4665B596706114, 0x873D5D9F0DDE1FEE,
+				0xEB57FF22FC0C7959, 0xA90CB506D155A7EA, 0x9316FF75DD87CBD8, 0x09A7F12442D588F2,
+				0xB7DCBF5354E9BECE, 0x0C11ED6D538AEB2F, 0xE5D3EF282A242E81, 0x8F1668C8A86DA5FA,
+				0x8FA475791A569D10, 0xF96E017D694487BC, 0xB38D92D760EC4455, 0x37C981DCC395A9AC,
+				0xE070F78D3927556A, 0x85BBE253F47B1417, 0x8C469AB843B89562, 0x93956D7478CCEC8E,
+				0xAF58416654A6BABB, 0x387AC8D1970027B2, 0xDB2E51BFE9D0696A, 0x06997B05FCC0319E,
+				0x88FCF317F22241E2, 0x441FECE3BDF81F03, 0xAB3C2FDDEEAAD25A, 0xD527E81CAD7626C3,
+				0xD60B3BD56A5586F1, 0x8A71E223D8D3B074, 0x85C7056562757456, 0xF6872D5667844E49,
+				0xA738C6BEBB12D16C, 0xB428F8AC016561DB, 0xD106F86E69D785C7, 0xE13336D701BEBA52,
+				0x82A45B450226B39C, 0xECC0024661173473, 0xA34D721642B06084, 0x27F002D7F95D0190,
+				0xCC20CE9BD35C78A5, 0x31EC038DF7B441F4, 0xFF290242C83396CE, 0x7E67047175A15271,
+				0x9F79A169BD203E41, 0x0F0062C6E984D386, 0xC75809C42C684DD1, 0x52C07B78A3E60868,
+				0xF92E0C3537826145, 0xA7709A56CCDF8A82, 0x9BBCC7A142B17CCB, 0x88A66076400BB691,
+				0xC2ABF989935DDBFE, 0x6ACFF893D00EA435, 0xF356F7EBF83552FE, 0x0583F6B8C4124D43,
+				0x98165AF37B2153DE, 0xC3727A337A8B704A, 0xBE1BF1B059E9A8D6, 0x744F18C0592E4C5C,
+				0xEDA2EE1C7064130C, 0x1162DEF06F79DF73, 0x9485D4D1C63E8BE7, 0x8ADDCB5645AC2BA8,
+				0xB9A74A0637CE2EE1, 0x6D953E2BD7173692, 0xE8111C87C5C1BA99, 0xC8FA8DB6CCDD0437,
+				0x910AB1D4DB9914A0, 0x1D9C9892400A22A2, 0xB54D5E4A127F59C8, 0x2503BEB6D00CAB4B,
+				0xE2A0B5DC971F303A, 0x2E44AE64840FD61D, 0x8DA471A9DE737E24, 0x5CEAECFED289E5D2,
+				0xB10D8E1456105DAD, 0x7425A83E872C5F47, 0xDD50F1996B947518, 0xD12F124E28F77719,
+				0x8A5296FFE33CC92F, 0x82BD6B70D99AAA6F, 0xACE73CBFDC0BFB7B, 0x636CC64D1001550B,
+				0xD8210BEFD30EFA5A, 0x3C47F7E05401AA4E, 0x8714A775E3E95C78, 0x65ACFAEC34810A71,
+				0xA8D9D1535CE3B396, 0x7F1839A741A14D0D, 0xD31045A8341CA07C, 0x1EDE48111209A050,
+				0x83EA2B892091E44D, 0x934AED0AAB460432, 0xA4E4B66B68B65D60, 0xF81DA84D5617853F,
+				0xCE1DE40642E3F4B9, 0x36251260AB9D668E, 0x80D2AE83E9CE78F3, 0xC1D72B7C6B426019,
+				0xA1075A24E4421730, 0xB24CF65B8612F81F, 0xC94930AE1D529CFC, 0xDEE033F26797B627,
+				0xFB9B7CD9A4A7443C, 0x169840EF017DA3B1, 0x9D412E0806E88AA5, 0x8E1F289560EE864E,
+				0xC491798A08A2AD4E, 0xF1A6F2BAB92A27E2, 0xF5B5D7EC8ACB58A2, 0xAE10AF696774B1DB,
+				0x9991A6F3D6BF1765, 0xACCA6DA1E0A8EF29, 0xBFF610B0CC6EDD3F, 0x17FD090A58D32AF3,
+				0xEFF394DCFF8A948E, 0xDDFC4B4CEF07F5B0, 0x95F83D0A1FB69CD9, 0x4ABDAF101564F98E,
+				0xBB764C4CA7A4440F, 0x9D6D1AD41ABE37F1, 0xEA53DF5FD18D5513, 0x84C86189216DC5ED,
+				0x92746B9BE2F8552C, 0x32FD3CF5B4E49BB4, 0xB7118682DBB66A77, 0x3FBC8C33221DC2A1,
+				0xE4D5E82392A40515, 0x0FABAF3FEAA5334A, 0x8F05B1163BA6832D, 0x29CB4D87F2A7400E,
+				0xB2C71D5BCA9023F8, 0x743E20E9EF511012, 0xDF78E4B2BD342CF6, 0x914DA9246B255416,
+				0x8BAB8EEFB6409C1A, 0x1AD089B6C2F7548E, 0xAE9672ABA3D0C320, 0xA184AC2473B529B1,
+				0xDA3C0F568CC4F3E8, 0xC9E5D72D90A2741E, 0x8865899617FB1871, 0x7E2FA67C7A658892,
+				0xAA7EEBFB9DF9DE8D, 0xDDBB901B98FEEAB7, 0xD51EA6FA85785631, 0x552A74227F3EA565,
+				0x8533285C936B35DE, 0xD53A88958F87275F, 0xA67FF273B8460356, 0x8A892ABAF368F137,
+				0xD01FEF10A657842C, 0x2D2B7569B0432D85, 0x8213F56A67F6B29B, 0x9C3B29620E29FC73,
+				0xA298F2C501F45F42, 0x8349F3BA91B47B8F, 0xCB3F2F7642717713, 0x241C70A936219A73,
+				0xFE0EFB53D30DD4D7, 0xED238CD383AA0110, 0x9EC95D1463E8A506, 0xF4363804324A40AA,
+				0xC67BB4597CE2CE48, 0xB143C6053EDCD0D5, 0xF81AA16FDC1B81DA, 0xDD94B7868E94050A,
+				0x9B10A4E5E9913128, 0xCA7CF2B4191C8326, 0xC1D4CE1F63F57D72, 0xFD1C2F611F63A3F0,
+				0xF24A01A73CF2DCCF, 0xBC633B39673C8CEC, 0x976E41088617CA01, 0xD5BE0503E085D813,
+				0xBD49D14AA79DBC82, 0x4B2D8644D8A74E18, 0xEC9C459D51852BA2, 0xDDF8E7D60ED1219E,
+				0x93E1AB8252F33B45, 0xCABB90E5C942B503, 0xB8DA1662E7B00A17, 0x3D6A751F3B936243,
+				0xE7109BFBA19C0C9D, 0x0CC512670A783AD4, 0x906A617D450187E2, 0x27FB2B80668B24C5,
+				0xB484F9DC9641E9DA, 0xB1F9F660802DEDF6, 0xE1A63853BBD26451, 0x5E7873F8A0396973,
+				0x8D07E33455637EB2, 0xDB0B487B6423E1E8, 0xB049DC016ABC5E5F, 0x91CE1A9A3D2CDA62,
+				0xDC5C5301C56B75F7, 0x7641A140CC7810FB, 0x89B9B3E11B6329BA, 0xA9E904C87FCB0A9D,
+				0xAC2820D9623BF429, 0x546345FA9FBDCD44, 0xD732290FBACAF133, 0xA97C177947AD4095,
+				0x867F59A9D4BED6C0, 0x49ED8EABCCCC485D, 0xA81F301449EE8C70, 0x5C68F256BFFF5A74,
+				0xD226FC195C6A2F8C, 0x73832EEC6FFF3111, 0x83585D8FD9C25DB7, 0xC831FD53C5FF7EAB,
+				0xA42E74F3D032F525, 0xBA3E7CA8B77F5E55, 0xCD3A1230C43FB26F, 0x28CE1BD2E55F35EB,
+				0x80444B5E7AA7CF85, 0x7980D163CF5B81B3, 0xA0555E361951C366, 0xD7E105BCC332621F,
+				0xC86AB5C39FA63440, 0x8DD9472BF3FEFAA7, 0xFA856334878FC150, 0xB14F98F6F0FEB951,
+				0x9C935E00D4B9D8D2, 0x6ED1BF9A569F33D3, 0xC3B8358109E84F07, 0x0A862F80EC4700C8,
+				0xF4A642E14C6262C8, 0xCD27BB612758C0FA, 0x98E7E9CCCFBD7DBD, 0x8038D51CB897789C,
+				0xBF21E44003ACDD2C, 0xE0470A63E6BD56C3, 0xEEEA5D5004981478, 0x1858CCFCE06CAC74,
+				0x95527A5202DF0CCB, 0x0F37801E0C43EBC8, 0xBAA718E68396CFFD, 0xD30560258F54E6BA,
+				0xE950DF20247C83FD, 0x47C6B82EF32A2069, 0x91D28B7416CDD27E, 0x4CDC331D57FA5441,
+				0xB6472E511C81471D, 0xE0133FE4ADF8E952, 0xE3D8F9E563A198E5, 0x58180FDDD97723A6,
+				0x8E679C2F5E44FF8F, 0x570F09EAA7EA7648,
+			};
+			return table;
+		}
 
-		const C *s = this->ptr;
-		const C *end = s + this->length;
+		inline uint64_t mul_64x64(uint64_t a, uint64_t b, uint64_t &hi) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 r = (unsigned __int128)a * b;
+			hi = (uint64_t)(r >> 64);
+			return (uint64_t)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+			return _umul128(a, b, &hi);
+#else
+			uint64_t aLo = (uint32_t)a, aHi = a >> 32, bLo = (uint32_t)b, bHi = b >> 32;
+			uint64_t ll = aLo*bLo, lh = aLo*bHi, hl = aHi*bLo, hh = aHi*bHi;
+			uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+			hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+			return (mid << 32) | (uint32_t)ll;
+#endif
+		}
+
+		// Eisel-Lemire: the correctly rounded double nearest to w * 10^q, as biased exponent and mantissa bits.
+		// The approximation is always sufficient for an exact w; see "Fast Number Parsing Without Fallback"
+		// (Mushtak, Lemire).
+		inline uint64_t eisel_lemire(int64_t q, uint64_t w) noexcept
+		{
+			enum : int { MantissaBits = 52, InfinitePower = 0x7FF };
+			if (w == 0 || q < -342)
+				return 0;
+			if (q > 308)
+				return (uint64_t)InfinitePower << MantissaBits;
+
+			int lz = 63 - (int)bsr64(w);
+			w <<= lz;
+			const uint64_t *pow5 = power_of_five_128() + 2*(q + 342);
+			uint64_t hi, lo = mul_64x64(w, pow5[0], hi);
+			if ((hi & 0x1FF) == 0x1FF)
+			{
+				uint64_t hi2;
+				mul_64x64(w, pow5[1], hi2);
+				lo += hi2;
+				hi += hi2 > lo;
+			}
 
-		bool neg = *s == '-';
-		s += *s == '-' || *s == '+';
+			int upperBit = (int)(hi >> 63);
+			int shift = upperBit + 64 - MantissaBits - 3;
+			uint64_t mantissa = hi >> shift;
+			// floor(log2(10^q)) + 63, plus the exponent bias
+			int power2 = (int)(((152170 + 65536)*q) >> 16) + 63 + upperBit - lz + 1023;
+			if (power2 <= 0)
+			{
+				// subnormal
+				if (-power2 + 1 >= 64)
+					return 0;
+				mantissa >>= -power2 + 1;
+				mantissa += mantissa & 1;
+				mantissa >>= 1;
+				power2 = mantissa < ((uint64_t)1 << MantissaBits) ? 0 : 1;
+				return ((uint64_t)power2 << MantissaBits) | (mantissa & (((uint64_t)1 << MantissaBits) - 1));
+			}
+			// round half to even; exact halfway cases may only occur for small powers
+			if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == hi)
+				mantissa &= ~(uint64_t)1;
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+			if (mantissa >= ((uint64_t)2 << MantissaBits))
+			{
+				mantissa = (uint64_t)1 << MantissaBits;
+				++power2;
+			}
+			if (power2 >= InfinitePower)
+				return (uint64_t)InfinitePower << MantissaBits;
+			return ((uint64_t)power2 << MantissaBits) | (mantissa & (((uint64_t)1 << MantissaBits) - 1));
+		}
+
+		// accumulate decimal digits into v, wrapping on overflow; 1-byte strings take whole blocks of 8 digits at once
+		template <typename C>
+		inline const C* scan_digits(const C *p, const C *end, uint64_t &v) noexcept
+		{
+			while (sizeof(C) == 1 && end - p >= 8)
+			{
+				uint64_t block;
+				memcpy(&block, p, 8);
+				block ^= 0x3030303030303030;
+				if (((block + 0x7676767676767676) | block) & 0x8080808080808080)
+					break;
+				v = v*100000000 + swar_8digits(block);
+				p += 8;
+			}
+			for (; p < end && is_number(*p); ++p)
+				v = v*10 + (unsigned)(*p - '0');
+			return p;
+		}
 
-		size_t n = 0;
-		while (s < end && *s >= '0' && *s <= '9')
+		template <typename C>
+		inline size_t match_word_ic(const C *p, const C *end, const char *word) noexcept
 		{
-			n = n * 10 + *s - '0';
-			++s;
+			size_t i = 0;
+			for (; word[i]; ++i)
+			{
+				if (p + i == end || to_lower(p[i]) != (char32_t)word[i])
+					return 0;
+			}
+			return i;
 		}
 
-		double r;
-		if (*s == '.')
+		// Correctly rounded decimal to double conversion for numbers which Eisel-Lemire can't decide, because they
+		// have more than 19 significant digits. The significant digits are handed to strtod with an exponent and no
+		// decimal point, which is independent of locale. 769 digits are always enough to round correctly, provided
+		// any further non-zero digits are represented by a sticky digit.
+		template <typename C>
+		inline double parse_float_slow(const C *digits, const C *intEnd, const C *fracEnd, int64_t exp10) noexcept
 		{
-			++s;
-			size_t f = 0;
-			double fracSize = 1;
-			while (s < end && *s >= '0' && *s <= '9')
+			enum { MaxDigits = 769 };
+			char buffer[MaxDigits + 32];
+			size_t n = 0;
+			int64_t scale = exp10 + (intEnd - digits);
+			bool sticky = false;
+			for (const C *p = digits; p < fracEnd; ++p)
 			{
-				f = f * 10 + *s - '0';
-				fracSize *= 10;
-				++s;
+				if (p == intEnd)
+					continue; // the decimal point
+				if (n == 0 && *p == '0')
+				{
+					--scale;
+					continue;
+				}
+				if (n < MaxDigits)
+				{
+					buffer[n++] = (char)*p;
+					--scale;
+				}
+				else if (*p != '0')
+					sticky = true;
+			}
+			if (n == 0)
+				return 0;
+			if (sticky)
+			{
+				buffer[n++] = '1';
+				--scale;
 			}
-			r = (double)n + (double)f / fracSize;
+			// the value is now digits * 10^scale
+			buffer[n++] = 'e';
+			if (scale < 0)
+			{
+				buffer[n++] = '-';
+				scale = -scale;
+			}
+			char exp[24];
+			size_t e = 0;
+			do
+			{
+				exp[e++] = (char)('0' + scale % 10);
+				scale /= 10;
+			}
+			while (scale);
+			while (e)
+				buffer[n++] = exp[--e];
+			buffer[n] = 0;
+			return strtod(buffer, nullptr);
 		}
-		else
-			r = (double)n;
+	}
 
-		if (neg)
-			r = -r;
+	template<typename C>
+	inline double Slice<C, true>::parse_float(size_t *taken, bool *overflow) const noexcept
+	{
+		const C *s = this->ptr;
+		const C *end = this->ptr + this->length;
+		if (s < end && detail::is_whitespace(*s))
+			s += find_first_not_of<CharClass::Whitespace>();
+		if (taken)
+			*taken = 0;
+		if (overflow)
+			*overflow = false;
+
+		bool neg = s < end && *s == '-';
+		s += s < end && (*s == '-' || *s == '+');
+
+		// mantissa; w accumulates every digit, which is only meaningful up to 19 digits
+		const C *digits = s;
+		uint64_t w = 0;
+		s = detail::scan_digits(s, end, w);
+		const C *intEnd = s, *fracEnd = s;
+		int64_t fracDigits = 0;
+		if (s < end && *s == '.')
+		{
+			const C *frac = s + 1;
+			fracEnd = detail::scan_digits(frac, end, w);
+			fracDigits = fracEnd - frac;
+			if (fracDigits || intEnd > digits)
+				s = fracEnd;
+		}
+		int64_t numDigits = (intEnd - digits) + fracDigits;
 
-		if (*s == 'e' || *s == 'E')
+		uint64_t bits;
+		double r;
+		if (numDigits == 0)
 		{
-			++s;
-			bool negExp = *s == '-';
-			s += *s == '-' || *s == '+';
+			size_t len = detail::match_word_ic(s, end, "nan");
+			bits = 0x7FF8000000000000;
+			if (!len)
+			{
+				len = detail::match_word_ic(s, end, "infinity");
+				if (!len)
+					len = detail::match_word_ic(s, end, "inf");
+				bits = 0x7FF0000000000000;
+			}
+			if (!len)
+				return 0;
+			if (taken)
+				*taken = s + len - this->ptr;
+			memcpy(&r, &bits, sizeof(r));
+			return neg ? -r : r;
+		}
 
-			int16_t exp = 0;
-			while (s < end && *s >= '0' && *s <= '9')
+		// exponent; only taken when it has digits
+		int64_t exp10 = 0;
+		if (s < end && (*s | 0x20) == 'e')
+		{
+			const C *e = s + 1;
+			bool negExp = e < end && *e == '-';
+			e += e < end && (*e == '-' || *e == '+');
+			if (e < end && detail::is_number(*e))
 			{
-				exp = exp * 10 + *s - '0';
-				++s;
+				for (; e < end && detail::is_number(*e); ++e)
+				{
+					if (exp10 < 0x10000000)
+						exp10 = exp10*10 + (*e - '0');
+				}
+				if (negExp)
+					exp10 = -exp10;
+				s = e;
 			}
+		}
+		if (taken)
+			*taken = s - this->ptr;
 
-			// calculate 10^^exp
-			double e = 1;
-			double base = 10;
-			while (exp)
+		int64_t exponent = exp10 - fracDigits;
+		bool truncated = false;
+		if (numDigits > 19)
+		{
+			const C *p = digits;
+			while (p < fracEnd && (*p == '0' || *p == '.'))
 			{
-				if (exp & 1)
-					e *= base;
-				exp >>= 1;
-				base *= base;
+				numDigits -= *p == '0';
+				++p;
+			}
+			if (numDigits > 19)
+			{
+				// take the first 19 significant digits
+				truncated = true;
+				const uint64_t minNineteenDigits = 1000000000000000000;
+				w = 0;
+				p = digits;
+				while (w < minNineteenDigits && p < intEnd)
+					w = w*10 + (unsigned)(*p++ - '0');
+				if (w >= minNineteenDigits)
+					exponent = exp10 + (intEnd - p);
+				else
+				{
+					const C *frac = intEnd + 1;
+					p = frac;
+					while (w < minNineteenDigits && p < fracEnd)
+						w = w*10 + (unsigned)(*p++ - '0');
+					exponent = exp10 - (p - frac);
+				}
 			}
-			r = !negExp ? r * e : r / e;
 		}
 
-		return r;
+		if (!truncated && w <= (uint64_t)1 << 53 && exponent >= -22 && exponent <= 22
+#if defined(__FLT_EVAL_METHOD__)
+			&& __FLT_EVAL_METHOD__ == 0
+#endif
+			)
+		{
+			// Clinger's fast path; w and 10^exponent are exact doubles, so one operation rounds correctly
+			static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+											1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+			r = exponent < 0 ? (double)w / pow10[-exponent] : (double)w * pow10[exponent];
+			return neg ? -r : r;
+		}
+
+		bits = detail::eisel_lemire(exponent, w);
+		// when digits were dropped, the result is only known if w and w + 1 round the same way
+		if (truncated && bits != detail::eisel_lemire(exponent, w + 1))
+		{
+			r = detail::parse_float_slow(digits, intEnd, fracEnd, exp10);
+			memcpy(&bits, &r, sizeof(r));
+		}
+		if (overflow)
+			*overflow = bits == 0x7FF0000000000000;
+		memcpy(&r, &bits, sizeof(r));
+		return neg ? -r : r;
 	}
 
-	template<typename C>
-	inline uint32_t Slice<C, true>::hash(uint32_t hash) const noexcept
+	template <typename T, bool CI>
+	inline Searcher<T, CI>::Searcher(Slice<const value_type> needle) noexcept
+	{
+		using U = typename std::remove_pointer<decltype(impl.x)>::type;
+		impl.init((const U*)needle.ptr, needle.length, detail::SearchForward | detail::SearchReverse);
+	}
+	template <typename T, bool CI>
+	template <typename U, bool IgnoreCase, bool Simd>
+	inline size_t Searcher<T, CI>::Impl<U, IgnoreCase, Simd>::find_first(const U *y, size_t n) const noexcept
+	{
+		return m ? detail::FindSlice<U>::find_first(y, n, x, m) : 0;
+	}
+	template <typename T, bool CI>
+	template <typename U, bool IgnoreCase, bool Simd>
+	inline size_t Searcher<T, CI>::Impl<U, IgnoreCase, Simd>::find_last(const U *y, size_t n) const noexcept
+	{
+		return m ? detail::FindSlice<U>::find_last(y, n, x, m) : n;
+	}
+
+	template <typename T, bool CI>
+	inline size_t Searcher<T, CI>::find_first(Slice<const value_type> haystack) const noexcept
 	{
-		// TODO: is there a better hash for utf16/utf32?
-		const unsigned char *data = (const unsigned char *)this->ptr;
-		size_t len = this->length * sizeof(C);
-		for (size_t i = 0; i < len; ++i)
+		using U = typename std::remove_pointer<decltype(impl.x)>::type;
+		return impl.find_first((const U*)haystack.ptr, haystack.length);
+	}
+	template <typename T, bool CI>
+	inline size_t Searcher<T, CI>::find_last(Slice<const value_type> haystack) const noexcept
+	{
+		using U = typename std::remove_pointer<decltype(impl.x)>::type;
+		return impl.find_last((const U*)haystack.ptr, haystack.length);
+	}
+	template <typename T, bool CI>
+	template <typename Callback>
+	inline size_t Searcher<T, CI>::find_all(Slice<const value_type> haystack, Callback &&onMatch) const
+	{
+		// reports non-overlapping matches, in order
+		using U = typename std::remove_pointer<decltype(impl.x)>::type;
+		if (impl.m == 0)
+			return 0;
+		size_t numMatches = 0;
+		size_t offset = 0;
+		while (offset + impl.m <= haystack.length)
 		{
-			hash ^= (uint32_t)data[i];
-			hash *= 0x01000193;
+			size_t i = impl.find_first((const U*)haystack.ptr + offset, haystack.length - offset);
+			if (i == haystack.length - offset)
+				break;
+			onMatch(offset + i);
+			++numMatches;
+			offset += i + impl.m;
 		}
-		return hash;
+		return numMatches;
+	}
+	template <typename T, bool CI>
+	inline size_t Searcher<T, CI>::count(Slice<const value_type> haystack) const noexcept
+	{
+		return find_all(haystack, [](size_t) {});
 	}
 
 	namespace detail